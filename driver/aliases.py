@@ -20,6 +20,13 @@ ALIASES["seq-opt-decabstar"] = [
     'astar(max([epdbs, spdbs, ms]))'
 ]
 
+# seq-opt-decabstar, but the max heuristic evaluates its components in
+# increasing order of their time per call and stops at the f-bound of the
+# search. The h-values (and hence expansion counts) can be lower.
+ALIASES["seq-opt-decabstar-cheapest-first"] = (
+    ALIASES["seq-opt-decabstar"][:-1] +
+    ['astar(max([epdbs, spdbs, ms], cheapest_first=true, bound_cutoff=true))'])
+
 ALIASES["seq-sat-fd-autotune-1"] = [
     "--heuristic", "hff=ff(transform=adapt_costs(one))",
     "--heuristic", "hcea=cea()",
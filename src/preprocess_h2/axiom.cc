@@ -64,3 +64,16 @@ void Axiom::generate_cpp_input(ofstream &outfile) const {
     outfile << effect_var->get_level() << " " << old_val << " " << effect_val << endl;
     outfile << "end_rule" << endl;
 }
+
+void Axiom::generate_binary_input(ofstream &outfile) const {
+    assert(effect_var->get_level() != -1);
+    write_binary_int(outfile, conditions.size());
+    for (const Condition &condition : conditions) {
+        assert(condition.var->get_level() != -1);
+        write_binary_int(outfile, condition.var->get_level());
+        write_binary_int(outfile, condition.cond);
+    }
+    write_binary_int(outfile, effect_var->get_level());
+    write_binary_int(outfile, old_val);
+    write_binary_int(outfile, effect_val);
+}
@@ -1,3 +1,4 @@
+#include <cstdint>
 #include <cstdlib>
 #include <iostream>
 #include <fstream>
@@ -17,6 +18,8 @@ using namespace std;
 
 static const int SAS_FILE_VERSION = 3;
 static const int PRE_FILE_VERSION = SAS_FILE_VERSION;
+// first bytes of the binary output; must match the search component
+static const char BINARY_MAGIC[] = "\x7f" "SASBIN";
 
 
 void check_magic(istream &in, string magic) {
@@ -202,6 +205,67 @@ void generate_cpp_input(const vector<Variable *> &ordered_vars,
 
     outfile.close();
 }
+void write_binary_int(ofstream &outfile, int value) {
+    int32_t raw = value;
+    outfile.write(reinterpret_cast<const char *>(&raw), sizeof(raw));
+}
+
+void write_binary_string(ofstream &outfile, const string &value) {
+    write_binary_int(outfile, value.size());
+    outfile.write(value.data(), value.size());
+}
+
+void generate_binary_input(const vector<Variable *> &ordered_vars,
+                           const bool &metric,
+                           const vector<MutexGroup> &mutexes,
+                           const State &initial_state,
+                           const vector<pair<Variable *, int>> &goals,
+                           const vector<Operator> &operators,
+                           const vector<Axiom> &axioms) {
+    ofstream outfile;
+    outfile.open("output.sas", ios::out | ios::binary);
+
+    outfile.write(BINARY_MAGIC, sizeof(BINARY_MAGIC));
+    write_binary_int(outfile, PRE_FILE_VERSION);
+    write_binary_int(outfile, metric);
+
+    int num_vars = ordered_vars.size();
+    write_binary_int(outfile, num_vars);
+    for (Variable *var : ordered_vars)
+        var->generate_binary_input(outfile);
+
+    write_binary_int(outfile, mutexes.size());
+    for (const MutexGroup &mutex : mutexes)
+        mutex.generate_binary_input(outfile);
+
+    for (Variable *var : ordered_vars)
+        write_binary_int(outfile, initial_state[var]);
+
+    vector<int> ordered_goal_values;
+    ordered_goal_values.resize(num_vars, -1);
+    for (const auto &goal : goals) {
+        int var_index = goal.first->get_level();
+        ordered_goal_values[var_index] = goal.second;
+    }
+    write_binary_int(outfile, goals.size());
+    for (int i = 0; i < num_vars; i++) {
+        if (ordered_goal_values[i] != -1) {
+            write_binary_int(outfile, i);
+            write_binary_int(outfile, ordered_goal_values[i]);
+        }
+    }
+
+    write_binary_int(outfile, operators.size());
+    for (const Operator &op : operators)
+        op.generate_binary_input(outfile);
+
+    write_binary_int(outfile, axioms.size());
+    for (const Axiom &axiom : axioms)
+        axiom.generate_binary_input(outfile);
+
+    outfile.close();
+}
+
 void generate_unsolvable_cpp_input() {
     ofstream outfile;
     outfile.open("output.sas", ios::out);
@@ -41,6 +41,21 @@ void generate_cpp_input(const vector<Variable *> &ordered_var,
                         const vector<pair<Variable *, int>> &goals,
                         const vector<Operator> &operators,
                         const vector<Axiom> &axioms);
+/*
+  Binary variant of generate_cpp_input, which the search component can map
+  into memory instead of parsing it. It contains the same sections in the
+  same order; all numbers are 32-bit ints in the byte order of the machine,
+  strings are stored as their length followed by their characters.
+*/
+void generate_binary_input(const vector<Variable *> &ordered_var,
+                           const bool &metric,
+                           const vector<MutexGroup> &mutexes,
+                           const State &initial_state,
+                           const vector<pair<Variable *, int>> &goals,
+                           const vector<Operator> &operators,
+                           const vector<Axiom> &axioms);
+void write_binary_int(ofstream &outfile, int value);
+void write_binary_string(ofstream &outfile, const string &value);
 void check_magic(istream & in, string magic);
 
 #endif
@@ -36,6 +36,7 @@ public:
         return facts.size();
     }
     void generate_cpp_input(ofstream &outfile) const;
+    void generate_binary_input(ofstream &outfile) const;
     void dump() const;
     void get_mutex_group(vector<pair<int, int>> &invariant_group) const;
 
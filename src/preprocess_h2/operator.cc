@@ -123,6 +123,31 @@ void Operator::generate_cpp_input(ofstream &outfile) const {
     outfile << "end_operator" << endl;
 }
 
+void Operator::generate_binary_input(ofstream &outfile) const {
+    write_binary_string(outfile, name);
+
+    write_binary_int(outfile, prevail.size());
+    for (const auto &prev : prevail) {
+        assert(prev.var->get_level() != -1);
+        write_binary_int(outfile, prev.var->get_level());
+        write_binary_int(outfile, prev.prev);
+    }
+
+    write_binary_int(outfile, pre_post.size());
+    for (const auto &eff : pre_post) {
+        assert(eff.var->get_level() != -1);
+        write_binary_int(outfile, eff.effect_conds.size());
+        for (const auto &cond : eff.effect_conds) {
+            write_binary_int(outfile, cond.var->get_level());
+            write_binary_int(outfile, cond.cond);
+        }
+        write_binary_int(outfile, eff.var->get_level());
+        write_binary_int(outfile, eff.pre);
+        write_binary_int(outfile, eff.post);
+    }
+    write_binary_int(outfile, cost);
+}
+
 // Removes ambiguity in the preconditions,
 // detects whether the operator is spurious
 void Operator::remove_ambiguity(const H2Mutexes &h2) {
@@ -21,6 +21,7 @@ int main(int argc, const char **argv) {
     bool include_augmented_preconditions = false;
     bool expensive_statistics = false;
     bool disable_bw_h2 = false;
+    bool binary_output = false;
 
     bool metric;
     vector<Variable *> variables;
@@ -57,9 +58,11 @@ int main(int argc, const char **argv) {
             disable_bw_h2 = true;
         } else if (arg.compare("--stat") == 0) {
             expensive_statistics = true;
+        } else if (arg.compare("--binary_output") == 0) {
+            binary_output = true;
         } else {
             cerr << "unknown option " << arg << endl << endl;
-            cout << "Usage: ./preprocess [--no_rel] [--no_h2]  [--no_bw_h2] [--augmented_pre] [--stat] < output" << endl;
+            cout << "Usage: ./preprocess [--no_rel] [--no_h2]  [--no_bw_h2] [--augmented_pre] [--stat] [--binary_output] < output" << endl;
             exit(2);
         }
     }
@@ -241,6 +244,9 @@ int main(int argc, const char **argv) {
     if (ordering.empty()) {
         cout << "Unsolvable task in preprocessor" << endl;
         generate_unsolvable_cpp_input();
+    } else if (binary_output) {
+        generate_binary_input(
+            ordering, metric, mutexes, initial_state, goals, operators, axioms);
     } else {
         generate_cpp_input(
             ordering, metric, mutexes, initial_state, goals, operators, axioms);
@@ -25,6 +25,7 @@ public:
     int get_layer() const {return layer; }
     bool is_derived() const {return layer != -1; }
     void generate_cpp_input(ofstream &outfile) const;
+    void generate_binary_input(ofstream &outfile) const;
     void dump() const;
 
     string get_fact_name(int value) const {
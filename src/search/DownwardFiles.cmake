@@ -50,8 +50,10 @@ fast_downward_plugin(
 
         abstract_task
         axioms
+        binary_input
         combining_evaluator
         command_line
+        concurrent_predefinitions
         eager_search
         enforced_hill_climbing_search
         evaluator
@@ -147,6 +149,7 @@ fast_downward_plugin(
         utils/system
         utils/system_unix
         utils/system_windows
+        utils/thread_pool
         utils/timer
     CORE_PLUGIN
 )
@@ -179,6 +182,13 @@ fast_downward_plugin(
         open_lists/tiebreaking_open_list
 )
 
+fast_downward_plugin(
+    NAME BUCKET_TIEBREAKING_OPEN_LIST
+    HELP "Tiebreaking open list over two-level buckets of integer values"
+    SOURCES
+        open_lists/bucket_tiebreaking_open_list
+)
+
 fast_downward_plugin(
     NAME DYNAMIC_BITSET
     HELP "Poor man's version of boost::dynamic_bitset"
@@ -273,6 +283,8 @@ fast_downward_plugin(
         compliant_paths/explicit_state_cpg
         compliant_paths/frontier_prices
         compliant_paths/path_price_tag
+        compliant_paths/price_comparison
+        compliant_paths/price_vector
         compliant_paths/pricing_function
         compliant_paths/pruning_options
         compliant_paths/pruning_reachable
@@ -557,6 +569,7 @@ fast_downward_plugin(
         cost_saturation/projection
         cost_saturation/projection_generator
         cost_saturation/saturated_cost_partitioning_heuristic
+        cost_saturation/state_sampler
         cost_saturation/types
         cost_saturation/unsolvability_heuristic
         cost_saturation/utils
@@ -573,6 +586,7 @@ fast_downward_plugin(
         merge_and_shrink/clustering_lp_factoring
         merge_and_shrink/distances
         merge_and_shrink/factored_transition_system
+        merge_and_shrink/flat_merge_and_shrink_representation
         merge_and_shrink/fts_factory
         merge_and_shrink/label_equivalence_relation
         merge_and_shrink/label_reduction
@@ -649,6 +663,7 @@ fast_downward_plugin(
         pdbs/decoupled_canonical_pdbs_exponential_ilp
         pdbs/decoupled_canonical_pdbs_single_leaf
         pdbs/decoupled_pdb_utils
+        pdbs/decoupled_state_sampler
         pdbs/dominance_pruning
         pdbs/incremental_canonical_pdbs
         pdbs/match_tree
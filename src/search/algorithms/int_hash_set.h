@@ -291,6 +291,27 @@ public:
         return insert(key, hasher(key));
     }
 
+    /*
+      Remove the key (or an equivalent key) from the hash set and return
+      whether such a key was contained. Emptying the bucket is sufficient
+      since lookups always check all MAX_DISTANCE buckets of a key.
+    */
+    bool erase(KeyType key) {
+        assert(key >= 0);
+        HashType hash = hasher(key);
+        int ideal_index = get_bucket(hash);
+        for (int i = 0; i < MAX_DISTANCE; ++i) {
+            int index = get_bucket(ideal_index + i);
+            Bucket &bucket = buckets[index];
+            if (bucket.full() && bucket.hash == hash && equal(bucket.key, key)) {
+                bucket = Bucket();
+                --num_entries;
+                return true;
+            }
+        }
+        return false;
+    }
+
     void dump() const {
         int num_buckets = capacity();
         std::cout << "[";
@@ -0,0 +1,314 @@
+/*
+  Micro-benchmark for the open lists of A* with [f, h] tie-breaking:
+  tiebreaking([f, h]), single(f * (MAX_H + 1) + h), which orders entries
+  like [f, h], and bucket_tiebreaking([f, h]) with FIFO and LIFO buckets.
+
+  Usage: open_list_benchmark [TRACE | NUM_EXPANSIONS]
+
+  A trace is a sequence of operations, one per line: "i F H" inserts the
+  next entry (entries are numbered in insertion order) with the given
+  values, "p" removes the minimum. Without a trace file, a trace of A* on a
+  random search space with NUM_EXPANSIONS expansions (default 1000000) is
+  generated: every expansion inserts 1 to 6 successors whose g values grow
+  by action costs from 1 to 10 and whose h values change by at most the
+  action cost.
+
+  Every list replays the trace once interleaved as in the search and once
+  with all inserts before all pops, which gives the insert and pop
+  throughput separately. The order in which entries are removed must match
+  a reference (a std::map from [f, h] to FIFO or LIFO buckets) in both
+  replays.
+*/
+
+#include "../evaluator.h"
+#include "../open_lists/bucket_tiebreaking_open_list.h"
+#include "../open_lists/standard_scalar_open_list.h"
+#include "../open_lists/tiebreaking_open_list.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+struct Operation {
+    // values of the inserted entry, f = -1 for pops
+    int f;
+    int h;
+};
+
+static bool is_pop(const Operation &op) {
+    return op.f < 0;
+}
+
+// evaluator with the values of the next inserted entry
+class TraceEvaluator : public Evaluator {
+    int value;
+public:
+    TraceEvaluator() : value(0) {
+    }
+
+    void set_value(int new_value) {
+        value = new_value;
+    }
+
+    virtual void evaluate(int, bool) override {
+    }
+
+    virtual bool is_dead_end() const override {
+        return false;
+    }
+
+    virtual bool dead_end_is_reliable() const override {
+        return true;
+    }
+
+    virtual void get_involved_heuristics(set<Heuristic *> &) override {
+    }
+
+    virtual int get_value() const override {
+        return value;
+    }
+};
+
+static vector<Operation> read_trace(const string &file_name) {
+    ifstream in(file_name);
+    if (!in) {
+        cerr << "Could not open " << file_name << endl;
+        exit(1);
+    }
+    vector<Operation> trace;
+    string type;
+    while (in >> type) {
+        if (type == "p") {
+            trace.push_back({-1, -1});
+        } else {
+            Operation op;
+            if (type != "i" || !(in >> op.f >> op.h) || op.f < 0 || op.h < 0) {
+                cerr << "Invalid trace operation " << trace.size() << endl;
+                exit(1);
+            }
+            trace.push_back(op);
+        }
+    }
+    return trace;
+}
+
+/*
+  Reference open list used to check the pop order and to generate traces:
+  a std::map from [f, h] to buckets of entries.
+*/
+class ReferenceOpenList {
+    map<pair<int, int>, deque<int>> buckets;
+    bool lifo;
+public:
+    explicit ReferenceOpenList(bool lifo) : lifo(lifo) {
+    }
+
+    void insert(int f, int h, int entry) {
+        buckets[make_pair(f, h)].push_back(entry);
+    }
+
+    bool empty() const {
+        return buckets.empty();
+    }
+
+    int remove_min() {
+        auto it = buckets.begin();
+        deque<int> &bucket = it->second;
+        int entry = lifo ? bucket.back() : bucket.front();
+        if (lifo) {
+            bucket.pop_back();
+        } else {
+            bucket.pop_front();
+        }
+        if (bucket.empty()) {
+            buckets.erase(it);
+        }
+        return entry;
+    }
+};
+
+static vector<Operation> generate_trace(int num_expansions) {
+    mt19937 rng(2024);
+    uniform_int_distribution<int> num_successors_dist(1, 6);
+    uniform_int_distribution<int> cost_dist(1, 10);
+    vector<Operation> trace;
+    vector<int> g_values;
+    vector<int> h_values;
+    ReferenceOpenList open_list(false);
+    auto insert = [&](int g, int h) {
+            int entry = g_values.size();
+            g_values.push_back(g);
+            h_values.push_back(h);
+            trace.push_back({g + h, h});
+            open_list.insert(g + h, h, entry);
+        };
+    insert(0, 200);
+    for (int expansion = 0; expansion < num_expansions && !open_list.empty(); ++expansion) {
+        int entry = open_list.remove_min();
+        trace.push_back({-1, -1});
+        int num_successors = num_successors_dist(rng);
+        for (int i = 0; i < num_successors; ++i) {
+            int cost = cost_dist(rng);
+            int delta = uniform_int_distribution<int>(-cost, cost)(rng);
+            insert(g_values[entry] + cost, max(0, h_values[entry] + delta));
+        }
+    }
+    return trace;
+}
+
+static vector<int> compute_reference_order(const vector<Operation> &trace, bool lifo, bool bulk) {
+    ReferenceOpenList open_list(lifo);
+    vector<int> order;
+    int next_entry = 0;
+    for (const Operation &op : trace) {
+        if (!is_pop(op)) {
+            open_list.insert(op.f, op.h, next_entry++);
+        } else if (!bulk) {
+            order.push_back(open_list.remove_min());
+        }
+    }
+    while (bulk && !open_list.empty()) {
+        order.push_back(open_list.remove_min());
+    }
+    return order;
+}
+
+struct Evaluators {
+    shared_ptr<TraceEvaluator> f = make_shared<TraceEvaluator>();
+    shared_ptr<TraceEvaluator> h = make_shared<TraceEvaluator>();
+    // f * (max_h + 1) + h for the scalar open list
+    shared_ptr<TraceEvaluator> combined = make_shared<TraceEvaluator>();
+    int h_factor;
+};
+
+static void insert(OpenList<int> &open_list, Evaluators &evaluators,
+                   const Operation &op, int entry) {
+    evaluators.f->set_value(op.f);
+    evaluators.h->set_value(op.h);
+    evaluators.combined->set_value(op.f * evaluators.h_factor + op.h);
+    open_list.evaluate(0, false);
+    open_list.insert(entry);
+}
+
+/*
+  Replays the trace and returns the removed entries. In bulk mode, all
+  entries are inserted before the first one is removed.
+*/
+static vector<int> replay(OpenList<int> &open_list, Evaluators &evaluators,
+                          const vector<Operation> &trace, bool bulk,
+                          double &insert_time, double &pop_time) {
+    vector<int> order;
+    order.reserve(trace.size());
+    int next_entry = 0;
+    auto start = chrono::steady_clock::now();
+    for (const Operation &op : trace) {
+        if (!is_pop(op)) {
+            insert(open_list, evaluators, op, next_entry++);
+        } else if (!bulk) {
+            order.push_back(open_list.remove_min());
+        }
+    }
+    auto middle = chrono::steady_clock::now();
+    while (bulk && !open_list.empty()) {
+        order.push_back(open_list.remove_min());
+    }
+    auto end = chrono::steady_clock::now();
+    insert_time = chrono::duration<double>(middle - start).count();
+    pop_time = chrono::duration<double>(end - middle).count();
+    return order;
+}
+
+static bool run(const string &name, OpenList<int> &open_list, Evaluators &evaluators,
+                const vector<Operation> &trace, size_t num_inserts, size_t num_pops,
+                const vector<int> &interleaved_order, const vector<int> &bulk_order) {
+    double insert_time;
+    double pop_time;
+    vector<int> order = replay(open_list, evaluators, trace, false, insert_time, pop_time);
+    double interleaved_time = insert_time + pop_time;
+    if (order != interleaved_order) {
+        cerr << name << ": pop order differs from the reference in the interleaved replay" << endl;
+        return false;
+    }
+    open_list.clear();
+    order = replay(open_list, evaluators, trace, true, insert_time, pop_time);
+    if (order != bulk_order) {
+        cerr << name << ": pop order differs from the reference in the bulk replay" << endl;
+        return false;
+    }
+    open_list.clear();
+    cout << name << ": " << interleaved_time * 1e9 / (num_inserts + num_pops)
+         << " ns per operation interleaved, "
+         << num_inserts / insert_time << " inserts/s, "
+         << bulk_order.size() / pop_time << " pops/s in bulk"
+         << " (" << num_pops << " pops checked)" << endl;
+    return true;
+}
+
+int main(int argc, char **argv) {
+    vector<Operation> trace;
+    if (argc > 1 && string(argv[1]).find_first_not_of("0123456789") != string::npos) {
+        trace = read_trace(argv[1]);
+    } else {
+        trace = generate_trace(argc > 1 ? atoi(argv[1]) : 1000000);
+    }
+
+    size_t num_inserts = 0;
+    size_t num_pops = 0;
+    int max_f = 0;
+    int max_h = 0;
+    int size = 0;
+    for (const Operation &op : trace) {
+        if (is_pop(op)) {
+            if (size == 0) {
+                cerr << "Trace removes an entry from an empty open list" << endl;
+                return 1;
+            }
+            --size;
+            ++num_pops;
+        } else {
+            ++size;
+            ++num_inserts;
+            max_f = max(max_f, op.f);
+            max_h = max(max_h, op.h);
+        }
+    }
+    Evaluators evaluators;
+    evaluators.h_factor = max_h + 1;
+    if (max_f > (numeric_limits<int>::max() - max_h) / evaluators.h_factor) {
+        cerr << "f and h values too large for the combined scalar key" << endl;
+        return 1;
+    }
+    cout << "Trace: " << num_inserts << " inserts, " << num_pops << " pops, "
+         << "max f " << max_f << ", max h " << max_h << endl;
+
+    vector<int> fifo_order = compute_reference_order(trace, false, false);
+    vector<int> fifo_bulk_order = compute_reference_order(trace, false, true);
+    vector<int> lifo_order = compute_reference_order(trace, true, false);
+    vector<int> lifo_bulk_order = compute_reference_order(trace, true, true);
+
+    vector<shared_ptr<Evaluator>> f_and_h {evaluators.f, evaluators.h};
+    TieBreakingOpenList<int> tiebreaking(f_and_h, false, false);
+    StandardScalarOpenList<int> scalar(evaluators.combined, false);
+    BucketTieBreakingOpenList<int> bucket_fifo(f_and_h, false, false);
+    BucketTieBreakingOpenList<int> bucket_lifo(f_and_h, false, true);
+    bool ok = run("tiebreaking", tiebreaking, evaluators, trace, num_inserts,
+                  num_pops, fifo_order, fifo_bulk_order) &&
+        run("single(combined key)", scalar, evaluators, trace, num_inserts,
+            num_pops, fifo_order, fifo_bulk_order) &&
+        run("bucket_tiebreaking(fifo)", bucket_fifo, evaluators, trace,
+            num_inserts, num_pops, fifo_order, fifo_bulk_order) &&
+        run("bucket_tiebreaking(lifo)", bucket_lifo, evaluators, trace,
+            num_inserts, num_pops, lifo_order, lifo_bulk_order);
+    return ok ? 0 : 1;
+}
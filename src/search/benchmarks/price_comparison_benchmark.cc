@@ -0,0 +1,145 @@
+/*
+  Micro-benchmark for compare_prices(), the kernel comparing the dense
+  per-factor prices of two decoupled states in dominance checks.
+
+  Usage: price_comparison_benchmark [RECORDING [REPETITIONS]]
+
+  RECORDING is a file written by the planner with the pruning option
+  record_price_comparisons=RECORDING, e.g.
+  dominance(record_price_comparisons=prices.txt). Without a recording,
+  random pairs of price arrays are generated. All pairs are compared
+  REPETITIONS times (default 100) with each kernel supported by the CPU;
+  the results of the kernels must be identical.
+*/
+
+#include "../compliant_paths/price_comparison.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace std;
+
+struct PricePair {
+    vector<int> new_prices;
+    vector<int> old_prices;
+};
+
+static bool read_prices(istream &in, vector<int> &prices) {
+    size_t size;
+    if (!(in >> size)){
+        return false;
+    }
+    prices.resize(size);
+    for (int &price : prices){
+        in >> price;
+    }
+    return static_cast<bool>(in);
+}
+
+static vector<PricePair> read_recording(const string &file_name) {
+    ifstream in(file_name);
+    if (!in){
+        cerr << "Could not open " << file_name << endl;
+        exit(1);
+    }
+    vector<PricePair> pairs;
+    PricePair pair;
+    while (read_prices(in, pair.new_prices) && read_prices(in, pair.old_prices)){
+        pairs.push_back(pair);
+    }
+    return pairs;
+}
+
+/*
+  Random pairs with the structure of recorded ones: mostly equal reached
+  leaf states with small price differences.
+*/
+static vector<PricePair> generate_pairs(size_t num_pairs) {
+    mt19937 rng(2024);
+    uniform_int_distribution<int> size_dist(1, 512);
+    uniform_int_distribution<int> price_dist(0, 100);
+    uniform_int_distribution<int> percent(0, 99);
+    vector<PricePair> pairs(num_pairs);
+    for (PricePair &pair : pairs){
+        size_t size = size_dist(rng);
+        for (size_t i = 0; i < size; ++i){
+            int price = percent(rng) < 30 ? -1 : price_dist(rng);
+            int other = price;
+            if (price != -1 && percent(rng) < 20){
+                other = price_dist(rng);
+            } else if (percent(rng) < 1){
+                other = -1;
+            }
+            pair.new_prices.push_back(price);
+            pair.old_prices.push_back(other);
+        }
+    }
+    return pairs;
+}
+
+int main(int argc, char **argv) {
+    vector<PricePair> pairs = argc > 1 ? read_recording(argv[1]) : generate_pairs(100000);
+    int repetitions = argc > 2 ? atoi(argv[2]) : 100;
+    size_t num_entries = 0;
+    for (const PricePair &pair : pairs){
+        num_entries += pair.new_prices.size();
+    }
+    cout << "Price vector pairs: " << pairs.size() << " ("
+         << (pairs.empty() ? 0 : num_entries / pairs.size())
+         << " entries on average)" << endl;
+    cout << "Selected kernel: "
+         << get_price_comparison_kernel_name(get_price_comparison_kernel()) << endl;
+    if (pairs.empty()){
+        return 0;
+    }
+
+    vector<PriceComparison> expected;
+    for (const PricePair &pair : pairs){
+        expected.push_back(compare_prices_with_kernel(
+                               PriceComparisonKernel::SCALAR,
+                               pair.new_prices.data(), pair.new_prices.size(),
+                               pair.old_prices.data(), pair.old_prices.size()));
+    }
+
+    double scalar_time = 0;
+    for (PriceComparisonKernel kernel : {PriceComparisonKernel::SCALAR,
+                                         PriceComparisonKernel::SSE4_1,
+                                         PriceComparisonKernel::AVX2}){
+        if (!is_price_comparison_kernel_supported(kernel)){
+            cout << get_price_comparison_kernel_name(kernel) << ": not supported" << endl;
+            continue;
+        }
+        // accumulate a result so that the comparisons are not optimized away
+        int checksum = 0;
+        auto start = chrono::steady_clock::now();
+        for (int rep = 0; rep < repetitions; ++rep){
+            for (size_t i = 0; i < pairs.size(); ++i){
+                const PricePair &pair = pairs[i];
+                PriceComparison result = compare_prices_with_kernel(
+                    kernel,
+                    pair.new_prices.data(), pair.new_prices.size(),
+                    pair.old_prices.data(), pair.old_prices.size());
+                if (rep == 0 && !(result == expected[i])){
+                    cerr << get_price_comparison_kernel_name(kernel)
+                         << " differs from the scalar kernel on pair " << i << endl;
+                    return 1;
+                }
+                checksum += result.max_advantage;
+            }
+        }
+        chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+        double time = elapsed.count();
+        if (kernel == PriceComparisonKernel::SCALAR){
+            scalar_time = time;
+        }
+        cout << get_price_comparison_kernel_name(kernel) << ": "
+             << time * 1e9 / (static_cast<double>(pairs.size()) * repetitions)
+             << " ns per pair, speedup " << scalar_time / time
+             << " (checksum " << checksum << ")" << endl;
+    }
+    return 0;
+}
@@ -0,0 +1,83 @@
+/*
+  Micro-benchmark for the hash functions of packed states in the state
+  registry: the Jenkins hash of utils::HashState (the default) and the
+  block hash utils::hash_block, folded to 32 bits (USE_BLOCK_STATE_HASH).
+
+  Usage: state_hash_benchmark [NUM_STATES [NUM_BINS]]
+
+  The states are generated like packed states of a task with many small
+  variables: every state number is split into 2-bit variables that are
+  packed into the low bits of the bins, and the remaining bits of the bins
+  hold a fixed pattern, as variables that rarely change would. All states
+  are distinct. For each hash function, the benchmark reports the time per
+  state and the number of 32-bit hash collisions (states whose hash equals
+  that of an earlier state), compared to the expected number for a random
+  function, NUM_STATES^2 / 2^33. Defaults: 1000000 states with 12 bins.
+*/
+
+#include "../utils/hash.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+
+static vector<uint32_t> generate_states(size_t num_states, size_t num_bins) {
+    vector<uint32_t> states(num_states * num_bins);
+    for (size_t state = 0; state < num_states; ++state) {
+        uint64_t rest = state;
+        for (size_t bin = 0; bin < num_bins; ++bin) {
+            // four 2-bit variables per bin, fixed pattern above them
+            uint32_t value = 0x5a5a5a00U ^ static_cast<uint32_t>(bin << 12);
+            value |= static_cast<uint32_t>(rest & 0xFF);
+            rest >>= 8;
+            states[state * num_bins + bin] = value;
+        }
+    }
+    return states;
+}
+
+static uint32_t hash_jenkins(const uint32_t *data, size_t size) {
+    utils::HashState hash_state;
+    for (size_t i = 0; i < size; ++i) {
+        hash_state.feed(data[i]);
+    }
+    return hash_state.get_hash32();
+}
+
+static uint32_t hash_block_folded(const uint32_t *data, size_t size) {
+    return utils::fold_hash(utils::hash_block(data, size));
+}
+
+template<class HashFunction>
+static void run(const char *name, const vector<uint32_t> &states,
+                size_t num_states, size_t num_bins, HashFunction hash) {
+    vector<uint32_t> hashes(num_states);
+    auto start = chrono::steady_clock::now();
+    for (size_t state = 0; state < num_states; ++state) {
+        hashes[state] = hash(&states[state * num_bins], num_bins);
+    }
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+
+    sort(hashes.begin(), hashes.end());
+    size_t num_distinct = unique(hashes.begin(), hashes.end()) - hashes.begin();
+    cout << name << ": " << elapsed.count() * 1e9 / num_states
+         << " ns per state, " << num_states - num_distinct << " collisions" << endl;
+}
+
+int main(int argc, char **argv) {
+    size_t num_states = argc > 1 ? atol(argv[1]) : 1000000;
+    size_t num_bins = argc > 2 ? atol(argv[2]) : 12;
+    vector<uint32_t> states = generate_states(num_states, num_bins);
+
+    double expected = static_cast<double>(num_states) * num_states / 8589934592.0;
+    cout << num_states << " states with " << num_bins << " bins, "
+         << expected << " collisions expected for a random function" << endl;
+    run("HashState", states, num_states, num_bins, hash_jenkins);
+    run("hash_block", states, num_states, num_bins, hash_block_folded);
+    return 0;
+}
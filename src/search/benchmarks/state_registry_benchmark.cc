@@ -0,0 +1,220 @@
+/*
+  Micro-benchmark for the duplicate detection of the state registry: the
+  registered states as int_hash_set::IntHashSet (the current StateRegistry)
+  and as std::unordered_set (the registry before the switch to IntHashSet),
+  both keyed by state ids into a SegmentedArrayVector of packed states with
+  the hash and equality functors of StateRegistry.
+
+  Usage: state_registry_benchmark [NUM_STATES [NUM_BINS [GENERATIONS]]]
+
+  The trace mimics the successor generation of a search: GENERATIONS
+  generated states per registered state (default 3), where every generated
+  state is either a new state or a random earlier one. Every generation
+  pushes the packed state into the pool, inserts its id and pops the state
+  again if it is a duplicate, like StateRegistry::insert_id_or_pop_state.
+  For each set, the benchmark reports the time per generation, the
+  generations per second and the peak heap memory of the set per registered
+  state, excluding the state pool. Defaults: 1000000 states with 12 bins.
+*/
+
+#include "../algorithms/int_hash_set.h"
+#include "../algorithms/segmented_vector.h"
+#include "../utils/hash.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <random>
+#include <unordered_set>
+#include <vector>
+
+using namespace std;
+
+using StatePool = segmented_vector::SegmentedArrayVector<uint32_t>;
+
+/*
+  Heap accounting: all allocations of the benchmark go through these
+  operators, so the peak number of live bytes during a run measures the
+  memory of the set and the state pool.
+*/
+static size_t live_bytes = 0;
+static size_t peak_bytes = 0;
+// keeps the allocations aligned for all types
+static const size_t HEADER_BYTES = alignof(max_align_t);
+
+void *operator new(size_t size) {
+    char *block = static_cast<char *>(malloc(size + HEADER_BYTES));
+    if (!block) {
+        throw bad_alloc();
+    }
+    *reinterpret_cast<size_t *>(block) = size;
+    live_bytes += size;
+    peak_bytes = max(peak_bytes, live_bytes);
+    return block + HEADER_BYTES;
+}
+
+void operator delete(void *ptr) noexcept {
+    if (ptr) {
+        char *block = static_cast<char *>(ptr) - HEADER_BYTES;
+        live_bytes -= *reinterpret_cast<size_t *>(block);
+        free(block);
+    }
+}
+
+void operator delete(void *ptr, size_t) noexcept {
+    operator delete(ptr);
+}
+
+static uint32_t hash_packed_state(const uint32_t *data, int state_size) {
+    utils::HashState hash_state;
+    for (int i = 0; i < state_size; ++i) {
+        hash_state.feed(data[i]);
+    }
+    return hash_state.get_hash32();
+}
+
+struct StateIDSemanticHash {
+    const StatePool &state_data_pool;
+    int state_size;
+    StateIDSemanticHash(const StatePool &state_data_pool, int state_size)
+        : state_data_pool(state_data_pool),
+          state_size(state_size) {
+    }
+
+    uint32_t operator()(int id) const {
+        return hash_packed_state(state_data_pool[id], state_size);
+    }
+};
+
+struct StateIDSemanticEqual {
+    const StatePool &state_data_pool;
+    int state_size;
+    StateIDSemanticEqual(const StatePool &state_data_pool, int state_size)
+        : state_data_pool(state_data_pool),
+          state_size(state_size) {
+    }
+
+    bool operator()(int lhs, int rhs) const {
+        const uint32_t *lhs_data = state_data_pool[lhs];
+        const uint32_t *rhs_data = state_data_pool[rhs];
+        return equal(lhs_data, lhs_data + state_size, rhs_data);
+    }
+};
+
+using IntStateIDSet = int_hash_set::IntHashSet<StateIDSemanticHash, StateIDSemanticEqual>;
+using StdStateIDSet = unordered_set<int, StateIDSemanticHash, StateIDSemanticEqual>;
+
+static IntStateIDSet create_set(
+    const IntStateIDSet *, const StatePool &state_data_pool, int state_size) {
+    return IntStateIDSet(StateIDSemanticHash(state_data_pool, state_size),
+                         StateIDSemanticEqual(state_data_pool, state_size));
+}
+
+static StdStateIDSet create_set(
+    const StdStateIDSet *, const StatePool &state_data_pool, int state_size) {
+    return StdStateIDSet(0, StateIDSemanticHash(state_data_pool, state_size),
+                         StateIDSemanticEqual(state_data_pool, state_size));
+}
+
+static int insert(IntStateIDSet &set, int id) {
+    return set.insert(id).first;
+}
+
+static int insert(StdStateIDSet &set, int id) {
+    return *set.insert(id).first;
+}
+
+// packed state with the given number as in state_hash_benchmark
+static void pack_state(uint64_t state, vector<uint32_t> &bins) {
+    for (size_t bin = 0; bin < bins.size(); ++bin) {
+        uint32_t value = 0x5a5a5a00U ^ static_cast<uint32_t>(bin << 12);
+        value |= static_cast<uint32_t>(state & 0xFF);
+        state >>= 8;
+        bins[bin] = value;
+    }
+}
+
+// state numbers in generation order, each state is new or generated before
+static vector<uint64_t> generate_trace(size_t num_states, size_t generations) {
+    mt19937_64 rng(2024);
+    vector<uint64_t> trace;
+    trace.reserve(num_states * generations);
+    uint64_t num_new = 0;
+    while (num_new < num_states) {
+        if (num_new == 0 || rng() % generations == 0) {
+            trace.push_back(num_new++);
+        } else {
+            trace.push_back(rng() % num_new);
+        }
+    }
+    return trace;
+}
+
+// returns the checksum of the registered ids
+template<class Set>
+static uint64_t run(const char *name, const vector<uint64_t> &trace,
+                    size_t num_bins, size_t pool_bytes) {
+    vector<uint32_t> bins(num_bins);
+    size_t start_bytes = live_bytes;
+    peak_bytes = live_bytes;
+    StatePool state_data_pool(num_bins);
+    Set registered_states = create_set(
+        static_cast<const Set *>(nullptr), state_data_pool, num_bins);
+    uint64_t checksum = 0;
+    auto start = chrono::steady_clock::now();
+    for (uint64_t state : trace) {
+        pack_state(state, bins);
+        state_data_pool.push_back(bins.data());
+        int new_id = state_data_pool.size() - 1;
+        int id = insert(registered_states, new_id);
+        if (id != new_id) {
+            state_data_pool.pop_back();
+        }
+        checksum += id;
+    }
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+    size_t num_registered = state_data_pool.size();
+    double set_bytes = static_cast<double>(peak_bytes - start_bytes) - pool_bytes;
+    cout << name << ": " << elapsed.count() * 1e9 / trace.size()
+         << " ns per generation, " << trace.size() / elapsed.count()
+         << " generations/s, " << set_bytes / num_registered
+         << " bytes per state (checksum " << checksum << ")" << endl;
+    return checksum;
+}
+
+static size_t measure_pool_bytes(size_t num_states, size_t num_bins) {
+    vector<uint32_t> bins(num_bins);
+    size_t start_bytes = live_bytes;
+    peak_bytes = live_bytes;
+    {
+        StatePool state_data_pool(num_bins);
+        for (size_t state = 0; state < num_states; ++state) {
+            pack_state(state, bins);
+            state_data_pool.push_back(bins.data());
+        }
+    }
+    return peak_bytes - start_bytes;
+}
+
+int main(int argc, char **argv) {
+    size_t num_states = argc > 1 ? atol(argv[1]) : 1000000;
+    size_t num_bins = argc > 2 ? atol(argv[2]) : 12;
+    size_t generations = argc > 3 ? atol(argv[3]) : 3;
+    vector<uint64_t> trace = generate_trace(num_states, generations);
+    size_t pool_bytes = measure_pool_bytes(num_states, num_bins);
+    cout << num_states << " states with " << num_bins << " bins, "
+         << trace.size() << " generations, state pool: "
+         << static_cast<double>(pool_bytes) / num_states << " bytes per state"
+         << endl;
+
+    uint64_t expected = run<StdStateIDSet>("unordered_set", trace, num_bins, pool_bytes);
+    uint64_t checksum = run<IntStateIDSet>("IntHashSet", trace, num_bins, pool_bytes);
+    if (checksum != expected) {
+        cerr << "IntHashSet registered different ids than unordered_set" << endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,94 @@
+#include "binary_input.h"
+
+#include "utils/language.h"
+#include "utils/system.h"
+
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <iterator>
+
+#if OPERATING_SYSTEM == LINUX || OPERATING_SYSTEM == OSX
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+using namespace std;
+
+// must match the magic written by preprocess-h2
+static const char BINARY_MAGIC[] = "\x7f" "SASBIN";
+
+BinaryInput::BinaryInput(istream &in, int fd)
+    : data(nullptr), size(0), pos(0), mapping(nullptr) {
+#if OPERATING_SYSTEM == LINUX || OPERATING_SYSTEM == OSX
+    struct stat file_status;
+    if (fd != -1 && fstat(fd, &file_status) == 0 &&
+        S_ISREG(file_status.st_mode) && file_status.st_size > 0) {
+        size = file_status.st_size;
+        void *address = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (address != MAP_FAILED) {
+            mapping = address;
+            data = static_cast<const char *>(address);
+            return;
+        }
+        size = 0;
+    }
+#else
+    utils::unused_variable(fd);
+#endif
+    buffer.assign(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+    data = buffer.data();
+    size = buffer.size();
+}
+
+BinaryInput::~BinaryInput() {
+#if OPERATING_SYSTEM == LINUX || OPERATING_SYSTEM == OSX
+    if (mapping) {
+        munmap(mapping, size);
+    }
+#endif
+}
+
+bool BinaryInput::is_binary(istream &in) {
+    return in.peek() == BINARY_MAGIC[0];
+}
+
+void BinaryInput::check_available(size_t num_bytes) const {
+    if (size - pos < num_bytes) {
+        cerr << "Unexpected end of binary input." << endl;
+        utils::exit_with(utils::ExitCode::SEARCH_INPUT_ERROR);
+    }
+}
+
+void BinaryInput::read_and_verify_magic() {
+    check_available(sizeof(BINARY_MAGIC));
+    if (memcmp(data + pos, BINARY_MAGIC, sizeof(BINARY_MAGIC)) != 0) {
+        cerr << "Failed to match magic of binary input." << endl;
+        utils::exit_with(utils::ExitCode::SEARCH_INPUT_ERROR);
+    }
+    pos += sizeof(BINARY_MAGIC);
+}
+
+int BinaryInput::read_int() {
+    int32_t value;
+    check_available(sizeof(value));
+    memcpy(&value, data + pos, sizeof(value));
+    pos += sizeof(value);
+    return value;
+}
+
+string BinaryInput::read_string() {
+    int length = read_int();
+    if (length < 0) {
+        cerr << "Invalid string length in binary input." << endl;
+        utils::exit_with(utils::ExitCode::SEARCH_INPUT_ERROR);
+    }
+    check_available(length);
+    string result(data + pos, length);
+    pos += length;
+    return result;
+}
+
+bool BinaryInput::at_end() const {
+    return pos == size;
+}
@@ -0,0 +1,46 @@
+#ifndef BINARY_INPUT_H
+#define BINARY_INPUT_H
+
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+/*
+  Reader for the binary task format written by preprocess-h2 with
+  --binary_output. It contains the same sections as the text format; all
+  numbers are 32-bit ints in the byte order of the machine that wrote the
+  file, strings are stored as their length followed by their characters.
+
+  If the input is a regular file, it is mapped into memory. Otherwise (e.g.
+  for pipes), the remaining stream is read into a buffer.
+*/
+class BinaryInput {
+    std::vector<char> buffer;
+    const char *data;
+    std::size_t size;
+    std::size_t pos;
+    void *mapping;
+
+    void check_available(std::size_t num_bytes) const;
+public:
+    /*
+      fd is the file descriptor underlying the stream (e.g. 0 for std::cin)
+      or -1 if there is none; only then the file can be mapped.
+    */
+    BinaryInput(std::istream &in, int fd);
+    ~BinaryInput();
+
+    BinaryInput(const BinaryInput &) = delete;
+    BinaryInput &operator=(const BinaryInput &) = delete;
+
+    // Return true iff the stream starts with the magic of the binary format.
+    static bool is_binary(std::istream &in);
+
+    void read_and_verify_magic();
+    int read_int();
+    std::string read_string();
+    bool at_end() const;
+};
+
+#endif
@@ -1,5 +1,6 @@
 #include "command_line.h"
 
+#include "concurrent_predefinitions.h"
 #include "factoring.h"
 #include "option_parser.h"
 #include "plan_manager.h"
@@ -42,12 +43,28 @@ static int parse_int_arg(const string &name, const string &value) {
     }
 }
 
+static int get_num_construction_threads(const vector<string> &args) {
+    int num_threads = 1;
+    for (size_t i = 0; i + 1 < args.size(); ++i) {
+        if (sanitize_arg_string(args[i]) == "--concurrent-heuristics") {
+            num_threads = parse_int_arg(args[i], args[i + 1]);
+            if (num_threads < 1)
+                throw ArgError("argument for --concurrent-heuristics must be positive");
+        }
+    }
+    return num_threads;
+}
+
 static shared_ptr<SearchEngine> parse_cmd_line_aux(
     const vector<string> &args, options::Registry &registry, bool dry_run) {
     string plan_filename = "sas_plan";
     int num_previously_generated_plans = 0;
     bool is_part_of_anytime_portfolio = false;
     options::Predefinitions predefinitions;
+    // predefinitions are constructed concurrently only in the real run
+    int num_construction_threads = dry_run ? 1 : get_num_construction_threads(args);
+    ConcurrentPredefinitions concurrent_predefinitions(
+        registry, predefinitions, num_construction_threads);
 
     shared_ptr<SearchEngine> engine;
     /*
@@ -62,6 +79,7 @@ static shared_ptr<SearchEngine> parse_cmd_line_aux(
             if (is_last)
                 throw ArgError("missing argument after --search");
             ++i;
+            concurrent_predefinitions.construct_pending();
             OptionParser parser(sanitize_arg_string(args[i]), registry,
                                 predefinitions, dry_run);
             engine = parser.start_parsing<shared_ptr<SearchEngine>>();
@@ -93,9 +111,14 @@ static shared_ptr<SearchEngine> parse_cmd_line_aux(
             }
             cout << "Help output finished." << endl;
             exit(0);
-        } else if (arg == "--decoupling") {
+        } else if (arg == "--decoupling" || arg == "--factoring-cache") {
             // this is parsed separately
             ++i;
+        } else if (arg == "--concurrent-heuristics") {
+            if (is_last)
+                throw ArgError("missing argument after --concurrent-heuristics");
+            // this is parsed before the loop
+            ++i;
         } else if (arg == "--internal-plan-file") {
             if (is_last)
                 throw ArgError("missing argument after --internal-plan-file");
@@ -114,13 +137,19 @@ static shared_ptr<SearchEngine> parse_cmd_line_aux(
             if (is_last)
                 throw ArgError("missing argument after " + arg);
             ++i;
-            registry.handle_predefinition(arg.substr(2),
-                                          sanitize_arg_string(args[i]),
-                                          predefinitions, dry_run);
+            if (num_construction_threads > 1) {
+                concurrent_predefinitions.add(arg.substr(2),
+                                              sanitize_arg_string(args[i]));
+            } else {
+                registry.handle_predefinition(arg.substr(2),
+                                              sanitize_arg_string(args[i]),
+                                              predefinitions, dry_run);
+            }
         } else {
             throw ArgError("unknown option " + arg);
         }
     }
+    concurrent_predefinitions.construct_pending();
 
     if (engine) {
         // TODO use plan manager instead when merging recent search engines
@@ -142,6 +171,8 @@ static shared_ptr<Factoring> parse_decoupled_search_aux(
     options::Predefinitions predefinitions;
 
     shared_ptr<Factoring> decoupling;
+    string decoupling_config;
+    string factoring_cache_dir;
     /*
       Note that we don’t sanitize all arguments beforehand because filenames should remain as-is
       (no conversion to lower-case, no conversion of newlines to spaces).
@@ -157,6 +188,12 @@ static shared_ptr<Factoring> parse_decoupled_search_aux(
             OptionParser parser(sanitize_arg_string(args[i]), registry,
                                 predefinitions, dry_run);
             decoupling = parser.start_parsing<shared_ptr<Factoring>>();
+            decoupling_config = sanitize_arg_string(args[i]);
+        } else if (arg == "--factoring-cache") {
+            if (is_last)
+                throw ArgError("missing argument after --factoring-cache");
+            ++i;
+            factoring_cache_dir = args[i];
         } else if (arg == "--help" && dry_run) {
             cout << "Help:" << endl;
             bool txt2tags = false;
@@ -196,6 +233,9 @@ static shared_ptr<Factoring> parse_decoupled_search_aux(
         }
     }
 
+    if (decoupling && !factoring_cache_dir.empty()) {
+        decoupling->set_cache(factoring_cache_dir, decoupling_config);
+    }
     return decoupling;
 }
 
@@ -261,6 +301,19 @@ string usage(const string &progname) {
            "--evaluator EVALUATOR_PREDEFINITION\n"
            "    Predefines an evaluator that can afterwards be referenced\n"
            "    by the name that is specified in the definition.\n"
+           "--concurrent-heuristics NUM_THREADS\n"
+           "    Construct independent predefinitions such as --heuristic on up\n"
+           "    to NUM_THREADS threads. Only max_scp_single_leaf, gamer_pdbs,\n"
+           "    perimeter and merge_and_shrink are constructed concurrently,\n"
+           "    at most one of gamer_pdbs and perimeter at a time, all other\n"
+           "    predefinitions sequentially. The time limits of concurrent\n"
+           "    constructions are measured in wall-clock time. The CPU time\n"
+           "    limit of the planner is consumed up to NUM_THREADS times faster,\n"
+           "    but not beyond the summed time limits unless a construction\n"
+           "    uses several threads itself.\n"
+           "--factoring-cache DIRECTORY\n"
+           "    Store the factoring computed for --decoupling in the existing\n"
+           "    DIRECTORY and reuse it in later runs on the same task.\n"
            "--internal-plan-file FILENAME\n"
            "    Plan will be output to a file called FILENAME\n\n"
            "--internal-previous-portfolio-plans COUNTER\n"
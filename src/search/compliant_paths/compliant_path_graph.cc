@@ -36,6 +36,52 @@ unordered_map<size_t, vector<int>> CompliantPathGraph::non_dominated_states;
 
 unordered_map<size_t, unordered_map<uint64_t, vector<int>>> CompliantPathGraph::duplicate_table;
 
+unordered_map<size_t, vector<DominanceSignature>> CompliantPathGraph::dominance_signatures;
+
+size_t CompliantPathGraph::num_dominance_candidates = 0;
+
+size_t CompliantPathGraph::num_dominance_candidates_ruled_out = 0;
+
+
+void DominanceSignature::set_number_states(size_t factor, size_t number_states, int goal_cost) {
+    assert(2 * factor < data.size());
+    // INF goal cost is stored as 0
+    data[2 * factor] = (static_cast<uint64_t>(number_states) << 32) |
+            static_cast<uint32_t>(goal_cost + 1);
+}
+
+void DominanceSignature::add_leaf_state(size_t factor, size_t leaf_id) {
+    assert(2 * factor + 1 < data.size());
+    // Fibonacci hashing, the top 6 bits select the bit of the summary
+    uint64_t bit = (static_cast<uint64_t>(leaf_id) * 0x9E3779B97F4A7C15ULL) >> 58;
+    data[2 * factor + 1] |= uint64_t(1) << bit;
+}
+
+void DominanceSignature::check(const DominanceSignature &other, bool &may_be_dominated, bool &may_dominate) const {
+    if (data.size() != other.data.size()){
+        return;
+    }
+    for (size_t i = 0; i < data.size(); i += 2){
+        uint64_t number_states = data[i] >> 32;
+        uint64_t other_number_states = other.data[i] >> 32;
+        bool goal_reached = (data[i] & 0xFFFFFFFFULL) != 0;
+        bool other_goal_reached = (other.data[i] & 0xFFFFFFFFULL) != 0;
+        if (number_states > other_number_states ||
+                (goal_reached && !other_goal_reached) ||
+                (data[i + 1] & ~other.data[i + 1]) != 0){
+            may_be_dominated = false;
+        }
+        if (number_states < other_number_states ||
+                (!goal_reached && other_goal_reached) ||
+                (other.data[i + 1] & ~data[i + 1]) != 0){
+            may_dominate = false;
+        }
+        if (!may_be_dominated && !may_dominate){
+            return;
+        }
+    }
+}
+
 
 void CompliantPathGraph::set_cost_type(OperatorCost ct) {
     cost_type = ct;
@@ -70,6 +116,47 @@ void CompliantPathGraph::notify_new_center_state(const GlobalState &state, const
         assert(!g_symmetry_graph || non_dominated_states[state.get_id().hash()].size() == 0);
         non_dominated_states[state.get_id().hash()].push_back(0);
     }
+    if (pruning->use_dominance_signatures()){
+        dominance_signatures.erase(state.get_id().hash());
+        store_dominance_signature(state.get_id().hash(), 0, cpg.get_dominance_signature());
+    }
+}
+
+void CompliantPathGraph::store_dominance_signature(size_t base_state_id_hash, int dup, DominanceSignature &&signature) {
+    if (signature.empty()){
+        return;
+    }
+    vector<DominanceSignature> &signatures = dominance_signatures[base_state_id_hash];
+    if (signatures.size() <= static_cast<size_t>(dup)){
+        signatures.resize(dup + 1);
+    }
+    signatures[dup] = move(signature);
+}
+
+DOMINANCE CompliantPathGraph::check_dominance_candidate(const GlobalState &other,
+                                                        size_t base_state_id_hash,
+                                                        int dup,
+                                                        const DominanceSignature &signature,
+                                                        int g_advantage,
+                                                        DOMINANCE needed) {
+    ++num_dominance_candidates;
+    if (!signature.empty()){
+        const auto it = dominance_signatures.find(base_state_id_hash);
+        if (it != dominance_signatures.end() &&
+                static_cast<size_t>(dup) < it->second.size() &&
+                !it->second[dup].empty()){
+            bool may_be_dominated = true;
+            bool may_dominate = true;
+            signature.check(it->second[dup], may_be_dominated, may_dominate);
+            if ((!may_be_dominated && !may_dominate) ||
+                    (needed == DOMINANCE::DOMINATED && !may_be_dominated) ||
+                    (needed == DOMINANCE::DOMINATES && !may_dominate)){
+                ++num_dominance_candidates_ruled_out;
+                return DOMINANCE::NONE;
+            }
+        }
+    }
+    return check_dominance(other, g_advantage, needed);
 }
 
 pair<int, bool> CompliantPathGraph::check_dominance(const GlobalState &base_state,
@@ -105,6 +192,11 @@ pair<int, bool> CompliantPathGraph::check_dominance(const GlobalState &base_stat
 
     vector<int> dup_state_indeces;
 
+    DominanceSignature signature;
+    if (pruning->use_dominance_signatures()){
+        signature = get_dominance_signature();
+    }
+
     if (pruning->use_exact_duplicate_checking()){
         leaf_hash = get_hash();
         assert(duplicate_table.find(base_state_id_hash) != duplicate_table.end());
@@ -148,7 +240,7 @@ pair<int, bool> CompliantPathGraph::check_dominance(const GlobalState &base_stat
             // ignoring the g-values; we need to pay attention to properly handle dominated states with
             // lower g-value, though
 
-            DOMINANCE res = check_dominance(s);
+            DOMINANCE res = check_dominance_candidate(s, base_state_id_hash, dup, signature);
 
             if (res == DOMINANCE::EQUAL || res == DOMINANCE::DOMINATED){
                 int old_g = search_space->get_node(s).get_g();
@@ -195,7 +287,7 @@ pair<int, bool> CompliantPathGraph::check_dominance(const GlobalState &base_stat
                         needed = DOMINANCE::DOMINATED;
                     }
 
-                    DOMINANCE res = check_dominance(s, old_g - new_g, needed);
+                    DOMINANCE res = check_dominance_candidate(s, base_state_id_hash, dup, signature, old_g - new_g, needed);
 
                     if (res == DOMINANCE::DOMINATED || res == DOMINANCE::EQUAL){
                         // current state is dominated by or equal to a previously generated state
@@ -226,7 +318,7 @@ pair<int, bool> CompliantPathGraph::check_dominance(const GlobalState &base_stat
                         needed = DOMINANCE::DOMINATES;
                     }
 
-                    DOMINANCE res = check_dominance(s, old_g - new_g, needed);
+                    DOMINANCE res = check_dominance_candidate(s, base_state_id_hash, dup, signature, old_g - new_g, needed);
 
                     if (res == DOMINANCE::EQUAL || res == DOMINANCE::DOMINATES){
                         // state will replace old state in search
@@ -234,6 +326,9 @@ pair<int, bool> CompliantPathGraph::check_dominance(const GlobalState &base_stat
                         // new state, which can result in lower h value
                         // TODO setting h dirty is probably just needed when the new state dominates the old one
                         search_space->get_node(s).set_h_dirty();
+                        if (pruning->use_dominance_signatures()){
+                            store_dominance_signature(base_state_id_hash, dup, move(signature));
+                        }
                         return {dup, true};
                     } else if (pruning->include_g_in_dominance() && res == DOMINANCE::DOMINATED){
                         // treat as duplicate, need to tell search to not reopen/update parent
@@ -248,7 +343,7 @@ pair<int, bool> CompliantPathGraph::check_dominance(const GlobalState &base_stat
                 // pruned if it is dominated by/equal to its predecessor
                 assert(new_g >= old_g);
 
-                DOMINANCE res = check_dominance(s, old_g - new_g, DOMINANCE::DOMINATED);
+                DOMINANCE res = check_dominance_candidate(s, base_state_id_hash, dup, signature, old_g - new_g, DOMINANCE::DOMINATED);
 
                 if (res == DOMINANCE::DOMINATED || res == DOMINANCE::EQUAL){
                     return {dup, false};
@@ -270,6 +365,9 @@ pair<int, bool> CompliantPathGraph::check_dominance(const GlobalState &base_stat
         } else if (pruning->use_transitivity()){
             non_dominated_states[base_state_id_hash].push_back(curr_number_duplicates + 1);
         }
+        if (pruning->use_dominance_signatures()){
+            store_dominance_signature(base_state_id_hash, curr_number_duplicates + 1, move(signature));
+        }
         return {curr_number_duplicates + 1, false};
     }
 }
@@ -310,6 +408,10 @@ unique_ptr<CompliantPathGraph> CompliantPathGraph::get_init_state_cpg() {
 
 void CompliantPathGraph::print_statistics() {
     g_state_registry->print_decoupled_search_statistics();
+    if (pruning->use_dominance_signatures()){
+        cout << "Dominance candidates: " << num_dominance_candidates
+             << " (" << num_dominance_candidates_ruled_out << " ruled out by signatures)" << endl;
+    }
     if (g_factoring->get_leaf_representation_type() == LEAF_REPRESENTATION_TYPE::EXPLICIT){
         return PathPrices::print_statistics();
     } else {
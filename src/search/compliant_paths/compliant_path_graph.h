@@ -9,6 +9,7 @@
 #include "../per_state_information.h"
 #include "pruning_options.h"
 
+#include <cstdint>
 #include <unordered_map>
 #include <vector>
 
@@ -20,6 +21,36 @@ class GlobalState;
 class StateID;
 
 
+/*
+  Cheap summary of a decoupled state used to rule out candidates before
+  the full dominance check: per leaf factor the number of reached leaf
+  states, the goal cost, and a Bloom-style 64 bit summary of the reached
+  leaf states. A state can only be dominated by another one if all of its
+  reached leaf states (and goals) are reached there, too.
+*/
+class DominanceSignature {
+    // per factor: (number of states << 32 | goal cost + 1), reached summary
+    std::vector<std::uint64_t> data;
+
+public:
+    DominanceSignature() = default;
+
+    explicit DominanceSignature(size_t num_factors) : data(2 * num_factors, 0) {}
+
+    bool empty() const {
+        return data.empty();
+    }
+
+    void set_number_states(size_t factor, size_t number_states, int goal_cost);
+
+    void add_leaf_state(size_t factor, size_t leaf_id);
+
+    // sets may_be_dominated (may_dominate) to false if this state
+    // can not be dominated by (dominate) the state of other
+    void check(const DominanceSignature &other, bool &may_be_dominated, bool &may_dominate) const;
+};
+
+
 class CompliantPathGraph {
     friend class PathPrices; // get_successor_via_center_action()
     friend class SearchSpace; // init state cpg + get successors
@@ -42,6 +73,13 @@ class CompliantPathGraph {
     // pruning, if they are indeed equal to a previously seen state.
     static std::unordered_map<size_t, std::unordered_map<std::uint64_t, std::vector<int>>> duplicate_table;
 
+    // when pruning->use_dominance_signatures() is enabled:
+    // the signatures of the decoupled states of every base state, indexed by dup counter
+    static std::unordered_map<size_t, std::vector<DominanceSignature>> dominance_signatures;
+
+    static size_t num_dominance_candidates;
+    static size_t num_dominance_candidates_ruled_out;
+
 
     static void initialize();
 
@@ -56,6 +94,17 @@ class CompliantPathGraph {
             const GlobalState &predecessor,
             const Operator &op);
 
+    static void store_dominance_signature(size_t base_state_id_hash, int dup, DominanceSignature &&signature);
+
+    // check_dominance(other, ...) unless the signatures rule out the needed result,
+    // other is the decoupled state with dup counter dup of base_state_id_hash
+    DOMINANCE check_dominance_candidate(const GlobalState &other,
+                                        size_t base_state_id_hash,
+                                        int dup,
+                                        const DominanceSignature &signature,
+                                        int g_advantage = 0,
+                                        DOMINANCE needed = DOMINANCE::NONE);
+
 protected:
 
     static SearchSpace *search_space;
@@ -80,6 +129,12 @@ protected:
 
     virtual bool is_hypercube_covered(const GlobalState &base_state, int curr_number_duplicates) const = 0;
 
+    // the empty signature if the dominance check of this CPG type does
+    // not require the reached leaf states to be a subset/superset
+    virtual DominanceSignature get_dominance_signature() const {
+        return DominanceSignature();
+    }
+
 public:
 
     static const int INF;
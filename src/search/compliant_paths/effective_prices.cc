@@ -42,7 +42,7 @@ EffectivePrices& EffectivePrices::operator=(EffectivePrices &&other) {
 void EffectivePrices::resize() {
     assert(g_factoring->get_profile() == FACTORING_PROFILE::FORK);
     number_states = vector<size_t>(g_leaves.size(), 0);
-    prices = vector<vector<int> >(g_leaves.size());
+    prices = vector<PriceVector>(g_leaves.size());
     goal_cost = vector<int>(g_leaves.size(), INF);
     // TODO why dont we resize effective_prices + number..? see also above comment
 }
@@ -60,7 +60,10 @@ bool EffectivePrices::add_effective_state(LeafStateHash id, LeafFactorID factor,
         if (has_leaf_state(id, factor) && cost >= get_cost_of_state(id, factor)) {
             return false;
         }
-        effective_prices = prices;
+        effective_prices.resize(g_leaves.size());
+        for (LeafFactorID f(0); f < g_leaves.size(); ++f){
+            effective_prices[f] = prices[f].get_dense();
+        }
         number_effective_states = number_states;
     }
 
@@ -313,6 +316,7 @@ size_t EffectivePrices::get_number_effective_states(LeafFactorID factor) const {
 }
 
 void EffectivePrices::store_new_cpg(const GlobalState &state) {
+    prepare_for_storage();
     cpg_storage->store_cpg(state, *this);
 }
 
@@ -401,7 +405,7 @@ void EffectivePrices::propagate_dominance_prices() {
 
 void EffectivePrices::apply_symmetry_permutation(const symmetries::LeavesPermutation &per) {
     // Copy prices and reinitialize affected factors
-    vector<vector<int> > old_prices(g_leaves.size());
+    vector<PriceVector> old_prices(g_leaves.size());
     vector<size_t> old_number_states(g_leaves.size());
     vector<vector<int> > old_effective_prices(g_leaves.size());
     vector<size_t> old_number_effective_states(g_leaves.size());
@@ -418,7 +422,7 @@ void EffectivePrices::apply_symmetry_permutation(const symmetries::LeavesPermuta
         old_prices[factor] = prices[factor];
 
         number_states[factor] = 0;
-        prices[factor] = vector<int>();
+        prices[factor] = PriceVector();
         goal_cost[factor] = INF;
         if (!effective_prices.empty()){
             old_effective_prices[factor] = effective_prices[factor];
@@ -450,8 +454,7 @@ void EffectivePrices::apply_symmetry_permutation(const symmetries::LeavesPermuta
             }
 
             size_t leaf_state = leaf_state_id_map[from_factor][id];
-            if (leaf_state >= old_prices[from_factor].size() ||
-                    old_prices[from_factor][leaf_state] == INF){
+            if (old_prices[from_factor][leaf_state] == INF){
                 continue;
             }
 
@@ -46,6 +46,11 @@ protected:
 
     virtual void store_new_cpg(const GlobalState &state) override;
 
+    // dominance is checked on the effective prices, no signature
+    virtual DominanceSignature get_dominance_signature() const override {
+        return DominanceSignature();
+    }
+
 public:
 
     EffectivePrices(){
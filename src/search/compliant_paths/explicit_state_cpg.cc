@@ -15,6 +15,9 @@
 #include "../task_utils/successor_generator.h"
 #include "../utils/timer.h"
 
+#include <algorithm>
+#include <map>
+
 
 using namespace std;
 
@@ -49,6 +52,14 @@ vector<vector<int> > ExplicitStateCPG::leaf_state_id_map;
 
 vector<size_t> ExplicitStateCPG::curr_leaf_state_max_id;
 
+vector<int> ExplicitStateCPG::center_precondition_class;
+
+vector<vector<Condition> > ExplicitStateCPG::center_precondition_classes;
+
+vector<unsigned int> ExplicitStateCPG::center_applicability_cache;
+
+unsigned int ExplicitStateCPG::center_applicability_stamp = 0;
+
 
 
 bool ExplicitStateCPG::is_leaf_goal_state(LeafStateHash id, LeafFactorID factor) {
@@ -635,6 +646,48 @@ bool ExplicitStateCPG::is_optimal_leaf_plan(int leaf_part_g) const {
     return true;
 }
 
+void ExplicitStateCPG::compute_center_precondition_classes() {
+    map<vector<Condition>, int> class_ids;
+    center_precondition_class.resize(g_operators.size());
+    center_precondition_classes.clear();
+    for (size_t op_id = 0; op_id < g_operators.size(); ++op_id){
+        OpsLeafProps<Condition> pre = g_operators[op_id].get_preconditions(LeafFactorID::CENTER);
+        vector<Condition> center_pre(pre.begin(), pre.end());
+        sort(center_pre.begin(), center_pre.end());
+        auto [it, inserted] = class_ids.emplace(center_pre, center_precondition_classes.size());
+        if (inserted){
+            center_precondition_classes.push_back(move(center_pre));
+        }
+        center_precondition_class[op_id] = it->second;
+    }
+    center_applicability_cache.assign(center_precondition_classes.size(), 0);
+    center_applicability_stamp = 0;
+    cout << "Number of distinct center preconditions: " << center_precondition_classes.size() << endl;
+}
+
+void ExplicitStateCPG::reset_center_applicability_cache() {
+    if (center_precondition_class.size() != g_operators.size()){
+        compute_center_precondition_classes();
+    }
+    // the lowest bit of a cache entry is the result of the test
+    if (++center_applicability_stamp == (numeric_limits<unsigned int>::max() >> 1)){
+        fill(center_applicability_cache.begin(), center_applicability_cache.end(), 0);
+        center_applicability_stamp = 1;
+    }
+}
+
+bool ExplicitStateCPG::compute_center_applicability(int pre_class, const GlobalState &center_state) {
+    bool applicable = true;
+    for (const Condition &cond : center_precondition_classes[pre_class]){
+        if (!cond.is_applicable(center_state)){
+            applicable = false;
+            break;
+        }
+    }
+    center_applicability_cache[pre_class] = (center_applicability_stamp << 1) | (applicable ? 1 : 0);
+    return applicable;
+}
+
 void ExplicitStateCPG::print_statistics() {
     size_t min_leaf_factor_size = numeric_limits<int>::max();
     double avg_leaf_factor_size = 0;
@@ -656,5 +709,12 @@ void ExplicitStateCPG::print_statistics() {
         cout << "avg reachable leaf factor size "  << (int) (avg_leaf_factor_size/g_leaves.size()) << endl;
         cout << "max reachable leaf factor size "  << max_leaf_factor_size << endl;
     }
+    if (pruning->use_hash_consing()){
+        if (g_factoring->get_search_type() == SAT || g_factoring->get_search_type() == UNSAT){
+            SharedLeafData<boost::dynamic_bitset<> >::print_statistics("reachable leaf state sets");
+        } else {
+            PriceVector::print_statistics();
+        }
+    }
 }
 
@@ -3,7 +3,10 @@
 
 #include "compliant_path_graph.h"
 
+#include <memory>
 
+
+struct Condition;
 class Prices;
 
 namespace stubborn_sets_decoupled {
@@ -68,6 +71,38 @@ protected:
 
     static std::vector<size_t> curr_leaf_state_max_id;
 
+    // leaf operators with the same center precondition form one class,
+    // center_precondition_class maps operators to their class
+    static std::vector<int> center_precondition_class;
+
+    static std::vector<std::vector<Condition> > center_precondition_classes;
+
+    // stamp and result of the last applicability test per class, see
+    // is_center_applicable_cached()
+    static std::vector<unsigned int> center_applicability_cache;
+
+    static unsigned int center_applicability_stamp;
+
+
+    static void compute_center_precondition_classes();
+
+    // forget all applicability tests, to be called whenever the center state changes
+    static void reset_center_applicability_cache();
+
+    static bool compute_center_applicability(int pre_class, const GlobalState &center_state);
+
+    // returns op.is_center_applicable(center_state), testing every center
+    // precondition class at most once since the last reset_center_applicability_cache()
+    static bool is_center_applicable_cached(OperatorID op, const GlobalState &center_state) {
+        assert(op < center_precondition_class.size());
+        int pre_class = center_precondition_class[op];
+        unsigned int entry = center_applicability_cache[pre_class];
+        if ((entry >> 1) != center_applicability_stamp){
+            return compute_center_applicability(pre_class, center_state);
+        }
+        return entry & 1;
+    }
+
 
     virtual std::unique_ptr<CompliantPathGraph> get_successor_via_center_action(const GlobalState &new_center_state, const Operator &op) const override = 0;
 
@@ -92,6 +127,11 @@ public:
 
     virtual size_t get_number_states(LeafFactorID factor) const = 0;
 
+    // see PriceVector::get_identity, nullptr if not supported or unknown
+    virtual std::shared_ptr<const void> get_prices_identity(LeafFactorID /*factor*/) const {
+        return nullptr;
+    }
+
     virtual void populate_reached_leaf_facts(std::function<void(int, int)> f) const override = 0;
 
     virtual void populate_cost_of_leaf_facts(std::function<void(int, int, int)> f) const override = 0;
@@ -41,7 +41,7 @@ FrontierPrices& FrontierPrices::operator=(FrontierPrices &&other) {
 
 void FrontierPrices::resize() {
     number_states = vector<size_t>(g_leaves.size(), 0);
-    prices = vector<vector<int> >(g_leaves.size());
+    prices = vector<PriceVector>(g_leaves.size());
     goal_cost = vector<int>(g_leaves.size(), INF);
     // TODO why dont we resize effective_prices + number/frontier..? see also above comment
 }
@@ -73,6 +73,8 @@ void FrontierPrices::update(const GlobalState &new_center_state) {
     cout << "+++++++++++++++ STARTING UPDATE" << endl;
 #endif
 
+    reset_center_applicability_cache();
+
     for (LeafFactorID factor(0); factor < g_leaves.size(); ++factor){
 
         if (g_goals_per_factor[factor].empty()){
@@ -125,7 +127,7 @@ void FrontierPrices::update(const GlobalState &new_center_state) {
                     bool all_applicable = !pruning->propagate_goal_prices();
                     for (size_t o = 0; o < leaf_state_successors[factor][id].size(); ++o){
                         const Operator &op = g_operators[leaf_state_successors[factor][id][o].first];
-                        if (op.is_center_applicable(new_center_state)){
+                        if (is_center_applicable_cached(op.get_id(), new_center_state)){
                             LeafStateHash successor = leaf_state_successors[factor][id][o].second;
                             bool added = add_state(successor, factor,
                                                    cost + get_adjusted_action_cost(op, cost_type));
@@ -278,6 +280,7 @@ void FrontierPrices::apply_symmetry_permutation(const symmetries::LeavesPermutat
 }
 
 void FrontierPrices::store_new_cpg(const GlobalState &state) {
+    prepare_for_storage();
     cpg_storage->store_cpg(state, *this);
 }
 
@@ -384,7 +387,7 @@ void FrontierPrices::propagate_dominance_prices() {
 void FrontierPrices::compute_cost_frontier() {
     if (frontier.empty()){
         // frontier is only stored for states for which the dominance was already checked at some point
-        //assert(!frontier.empty() || g_state_registry->state_duplicate_counter[center.get_id().hash()] == 0);
+        //assert(!frontier.empty() || g_state_registry->get_max_dup_counter(center.get_id()) == 0);
 
         frontier.resize(g_leaves.size());
         for (LeafFactorID factor(0); factor < g_leaves.size(); ++factor){
@@ -48,7 +48,7 @@ PathPrices::PathPrices(const PathPrices &other) : Prices(other) {
 
 PathPrices::PathPrices(const ExplicitStateCPG &cpg) {
     number_states = vector<size_t>(g_leaves.size(), 0);
-    prices = vector<vector<int> >(g_leaves.size());
+    prices = vector<PriceVector>(g_leaves.size());
     goal_cost = vector<int>(g_leaves.size(), INF);
     paths = vector<vector<PathPriceInfo> >(g_leaves.size());
 
@@ -82,6 +82,8 @@ const PathPriceInfo& PathPrices::get_path_info(LeafStateHash id, LeafFactorID fa
 }
 
 void PathPrices::update(const GlobalState &base_state) {
+    reset_center_applicability_cache();
+
     for (LeafFactorID factor(0); factor < g_leaves.size(); ++factor){
 
         if (g_factoring->is_fork_leaf(factor)){
@@ -131,8 +133,7 @@ void PathPrices::update(const GlobalState &base_state) {
                         for (size_t o = 0; o < leaf_state_successors[factor][id].size(); ++o){
                             const Operator &op = g_operators[leaf_state_successors[factor][id][o].first];
                             if (g_factoring->is_ifork_leaf(factor) ||
-                                    op.is_center_applicable(base_state)){
-                                // TODO what about caching applicability per update?
+                                    is_center_applicable_cached(op.get_id(), base_state)){
                                 change |= add_state(leaf_state_successors[factor][id][o].second, factor,
                                                     cost + get_adjusted_action_cost(op, cost_type), op.get_id(), id);
                             }
@@ -148,7 +149,7 @@ void PathPrices::update(const GlobalState &base_state) {
                             const Operator &op = g_operators[op_id];
                             assert(op.get_affected_factor() != LeafFactorID::CENTER);
 
-                            if (op.has_effect_on(factor) && op.is_center_applicable(base_state)){
+                            if (op.has_effect_on(factor) && is_center_applicable_cached(op_id, base_state)){
                                 LeafStateHash lid = g_state_registry->get_successor_leaf_state_hash(predecessor, op);
 
                                 if (lid >= leaf_state_id_map[factor].size()){
@@ -240,14 +241,14 @@ void PathPrices::apply_center_op_to_leaves(const PathPrices &old_cpg, const Oper
 
 void PathPrices::apply_symmetry_permutation(const symmetries::LeavesPermutation &per) {
     // Copy prices and reinitialize affected factors
-    vector<vector<int> > old_prices(prices);
+    vector<PriceVector> old_prices(prices);
     vector<size_t> old_number_states(number_states);
     vector<int> old_goal_cost(goal_cost); // only for debugging
     vector<vector<PathPriceInfo> > old_paths(paths);
 
     for (LeafFactorID factor : per.get_factors_affected()) {
         number_states[factor] = 0;
-        prices[factor] = vector<int>();
+        prices[factor] = PriceVector();
         goal_cost[factor] = INF;
         paths[factor] = vector<PathPriceInfo>();
     }
@@ -271,7 +272,7 @@ void PathPrices::apply_symmetry_permutation(const symmetries::LeavesPermutation
             }
 
             size_t from_state_index = leaf_state_id_map[from_factor][id];
-            if (from_state_index >= old_prices[from_factor].size() || old_prices[from_factor][from_state_index] == INF){
+            if (old_prices[from_factor][from_state_index] == INF){
                 continue;
             }
 
@@ -539,8 +540,8 @@ void PathPrices::symmetry_plan_reconstruction(vector<OperatorID> &ops, vector<St
 
     // Phase 1: backtrace center solution path
     for (;;) {
-        const SearchNodeInfo &info = search_space->search_node_infos[current_state];
-        OperatorID op = info.creating_operator;
+        const SearchNodeParent &parent = search_space->search_node_parents[current_state];
+        OperatorID op = parent.get_creating_operator();
 
         states.push_back(current_state.get_id());
 
@@ -549,7 +550,7 @@ void PathPrices::symmetry_plan_reconstruction(vector<OperatorID> &ops, vector<St
         GlobalState new_state = g_initial_state();
         unique_ptr<SymmetryCPG> new_cpg;
         if (op != OperatorID::no_operator) {
-            GlobalState parent_state = g_state_registry->lookup_state(info.parent_state_id);
+            GlobalState parent_state = g_state_registry->lookup_state(parent.get_parent_state_id());
 
             new_state = g_state_registry->get_center_successor(parent_state, g_operators[op]);
             new_cpg = unique_ptr<symmetries::SymmetryCPG>(dynamic_cast<symmetries::SymmetryCPG*>(CPGStorage::storage->get_cpg(parent_state)->get_successor_via_center_action(new_state, g_operators[op]).release()));
@@ -568,13 +569,13 @@ void PathPrices::symmetry_plan_reconstruction(vector<OperatorID> &ops, vector<St
         }
 
         if (op == OperatorID::no_operator) {  // reached initial state => done
-            assert(info.parent_state_id == StateID::no_state);
+            assert(parent.get_parent_state_id() == StateID::no_state);
             break;
         }
 
         ops.push_back(op);
 
-        current_state = g_state_registry->lookup_state(info.parent_state_id);
+        current_state = g_state_registry->lookup_state(parent.get_parent_state_id());
     }
 
     // Phase 2: backwards-apply the permutations to get the real center action sequence
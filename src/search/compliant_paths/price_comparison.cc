@@ -0,0 +1,283 @@
+#include "price_comparison.h"
+
+#include "../utils/language.h"
+#include "../utils/system.h"
+
+#include <algorithm>
+#include <cassert>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <memory>
+
+/*
+  The vector kernels are compiled with target attributes, so they do not
+  depend on -march or -mavx2 flags. Whether the CPU supports them is
+  checked at runtime.
+*/
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define PRICE_COMPARISON_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+
+static const int INF_PRICE = -1;
+
+static inline void compare_scalar(const int *new_prices, const int *old_prices,
+                                  size_t begin, size_t end, PriceComparison &res) {
+    for (size_t i = begin; i < end; ++i){
+        int new_cost = new_prices[i];
+        int old_cost = old_prices[i];
+        bool new_reached = new_cost != INF_PRICE;
+        bool old_reached = old_cost != INF_PRICE;
+        res.new_only |= new_reached && !old_reached;
+        res.old_only |= old_reached && !new_reached;
+        if (new_reached && old_reached){
+            int diff = old_cost - new_cost;
+            if (diff >= 0){
+                res.max_advantage = max(res.max_advantage, diff);
+                res.min_advantage = min(res.min_advantage, diff);
+            }
+            if (diff <= 0){
+                res.max_disadvantage = max(res.max_disadvantage, -diff);
+                res.min_disadvantage = min(res.min_disadvantage, -diff);
+            }
+        }
+    }
+}
+
+static inline bool any_reached(const int *prices, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i){
+        if (prices[i] != INF_PRICE){
+            return true;
+        }
+    }
+    return false;
+}
+
+#ifdef PRICE_COMPARISON_X86_KERNELS
+// the reductions of the vector registers, lanes stored to memory
+static inline void reduce_lanes(const int *new_only, const int *old_only,
+                                const int *max_adv, const int *max_dis,
+                                const int *min_adv, const int *min_dis,
+                                size_t lanes, PriceComparison &res) {
+    for (size_t l = 0; l < lanes; ++l){
+        res.new_only |= new_only[l] != 0;
+        res.old_only |= old_only[l] != 0;
+        res.max_advantage = max(res.max_advantage, max_adv[l]);
+        res.max_disadvantage = max(res.max_disadvantage, max_dis[l]);
+        res.min_advantage = min(res.min_advantage, min_adv[l]);
+        res.min_disadvantage = min(res.min_disadvantage, min_dis[l]);
+    }
+}
+
+/*
+  The vector kernels process the longest prefix of [0, common) that is a
+  multiple of the vector width and return its length.
+*/
+__attribute__((target("avx2")))
+static size_t compare_avx2(const int *new_prices, const int *old_prices,
+                           size_t common, PriceComparison &res) {
+    size_t i = 0;
+    if (common < 8){
+        return i;
+    }
+    const __m256i inf = _mm256_set1_epi32(INF_PRICE);
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i ones = _mm256_set1_epi32(-1);
+    const __m256i int_max = _mm256_set1_epi32(numeric_limits<int>::max());
+    __m256i new_only = zero;
+    __m256i old_only = zero;
+    __m256i max_adv = zero;
+    __m256i max_dis = zero;
+    __m256i min_adv = int_max;
+    __m256i min_dis = int_max;
+    for (; i + 8 <= common; i += 8){
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(new_prices + i));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(old_prices + i));
+        __m256i a_inf = _mm256_cmpeq_epi32(a, inf);
+        __m256i b_inf = _mm256_cmpeq_epi32(b, inf);
+        new_only = _mm256_or_si256(new_only, _mm256_andnot_si256(a_inf, b_inf));
+        old_only = _mm256_or_si256(old_only, _mm256_andnot_si256(b_inf, a_inf));
+        __m256i both = _mm256_andnot_si256(_mm256_or_si256(a_inf, b_inf), ones);
+        __m256i diff = _mm256_sub_epi32(b, a);
+        __m256i neg_diff = _mm256_sub_epi32(a, b);
+        max_adv = _mm256_max_epi32(max_adv, _mm256_and_si256(diff, both));
+        max_dis = _mm256_max_epi32(max_dis, _mm256_and_si256(neg_diff, both));
+        __m256i adv = _mm256_andnot_si256(_mm256_cmpgt_epi32(zero, diff), both);
+        __m256i dis = _mm256_andnot_si256(_mm256_cmpgt_epi32(diff, zero), both);
+        min_adv = _mm256_min_epi32(min_adv, _mm256_blendv_epi8(int_max, diff, adv));
+        min_dis = _mm256_min_epi32(min_dis, _mm256_blendv_epi8(int_max, neg_diff, dis));
+    }
+    alignas(32) int lanes[6][8];
+    _mm256_store_si256(reinterpret_cast<__m256i *>(lanes[0]), new_only);
+    _mm256_store_si256(reinterpret_cast<__m256i *>(lanes[1]), old_only);
+    _mm256_store_si256(reinterpret_cast<__m256i *>(lanes[2]), max_adv);
+    _mm256_store_si256(reinterpret_cast<__m256i *>(lanes[3]), max_dis);
+    _mm256_store_si256(reinterpret_cast<__m256i *>(lanes[4]), min_adv);
+    _mm256_store_si256(reinterpret_cast<__m256i *>(lanes[5]), min_dis);
+    reduce_lanes(lanes[0], lanes[1], lanes[2], lanes[3], lanes[4], lanes[5], 8, res);
+    return i;
+}
+
+__attribute__((target("sse4.1")))
+static size_t compare_sse4_1(const int *new_prices, const int *old_prices,
+                             size_t common, PriceComparison &res) {
+    size_t i = 0;
+    if (common < 4){
+        return i;
+    }
+    const __m128i inf = _mm_set1_epi32(INF_PRICE);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i ones = _mm_set1_epi32(-1);
+    const __m128i int_max = _mm_set1_epi32(numeric_limits<int>::max());
+    __m128i new_only = zero;
+    __m128i old_only = zero;
+    __m128i max_adv = zero;
+    __m128i max_dis = zero;
+    __m128i min_adv = int_max;
+    __m128i min_dis = int_max;
+    for (; i + 4 <= common; i += 4){
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(new_prices + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(old_prices + i));
+        __m128i a_inf = _mm_cmpeq_epi32(a, inf);
+        __m128i b_inf = _mm_cmpeq_epi32(b, inf);
+        new_only = _mm_or_si128(new_only, _mm_andnot_si128(a_inf, b_inf));
+        old_only = _mm_or_si128(old_only, _mm_andnot_si128(b_inf, a_inf));
+        __m128i both = _mm_andnot_si128(_mm_or_si128(a_inf, b_inf), ones);
+        __m128i diff = _mm_sub_epi32(b, a);
+        __m128i neg_diff = _mm_sub_epi32(a, b);
+        max_adv = _mm_max_epi32(max_adv, _mm_and_si128(diff, both));
+        max_dis = _mm_max_epi32(max_dis, _mm_and_si128(neg_diff, both));
+        __m128i adv = _mm_andnot_si128(_mm_cmpgt_epi32(zero, diff), both);
+        __m128i dis = _mm_andnot_si128(_mm_cmpgt_epi32(diff, zero), both);
+        min_adv = _mm_min_epi32(min_adv, _mm_blendv_epi8(int_max, diff, adv));
+        min_dis = _mm_min_epi32(min_dis, _mm_blendv_epi8(int_max, neg_diff, dis));
+    }
+    alignas(16) int lanes[6][4];
+    _mm_store_si128(reinterpret_cast<__m128i *>(lanes[0]), new_only);
+    _mm_store_si128(reinterpret_cast<__m128i *>(lanes[1]), old_only);
+    _mm_store_si128(reinterpret_cast<__m128i *>(lanes[2]), max_adv);
+    _mm_store_si128(reinterpret_cast<__m128i *>(lanes[3]), max_dis);
+    _mm_store_si128(reinterpret_cast<__m128i *>(lanes[4]), min_adv);
+    _mm_store_si128(reinterpret_cast<__m128i *>(lanes[5]), min_dis);
+    reduce_lanes(lanes[0], lanes[1], lanes[2], lanes[3], lanes[4], lanes[5], 4, res);
+    return i;
+}
+#endif
+
+static PriceComparisonKernel select_kernel() {
+#ifdef PRICE_COMPARISON_X86_KERNELS
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")){
+        return PriceComparisonKernel::AVX2;
+    }
+    if (__builtin_cpu_supports("sse4.1")){
+        return PriceComparisonKernel::SSE4_1;
+    }
+#endif
+    return PriceComparisonKernel::SCALAR;
+}
+
+static const PriceComparisonKernel best_kernel = select_kernel();
+
+bool PriceComparison::operator==(const PriceComparison &other) const {
+    return new_only == other.new_only && old_only == other.old_only &&
+           max_advantage == other.max_advantage &&
+           max_disadvantage == other.max_disadvantage &&
+           min_advantage == other.min_advantage &&
+           min_disadvantage == other.min_disadvantage;
+}
+
+PriceComparisonKernel get_price_comparison_kernel() {
+    return best_kernel;
+}
+
+bool is_price_comparison_kernel_supported(PriceComparisonKernel kernel) {
+    return static_cast<int>(kernel) <= static_cast<int>(best_kernel);
+}
+
+const char *get_price_comparison_kernel_name(PriceComparisonKernel kernel) {
+    switch (kernel){
+    case PriceComparisonKernel::SCALAR: return "scalar";
+    case PriceComparisonKernel::SSE4_1: return "SSE4.1";
+    case PriceComparisonKernel::AVX2: return "AVX2";
+    }
+    return "unknown";
+}
+
+PriceComparison compare_prices_with_kernel(PriceComparisonKernel kernel,
+                                           const int *new_prices, size_t new_size,
+                                           const int *old_prices, size_t old_size) {
+    assert(is_price_comparison_kernel_supported(kernel));
+    PriceComparison res{false, false, 0, 0,
+                        numeric_limits<int>::max(), numeric_limits<int>::max()};
+
+    size_t common = min(new_size, old_size);
+    size_t i = 0;
+#ifdef PRICE_COMPARISON_X86_KERNELS
+    if (kernel == PriceComparisonKernel::AVX2){
+        i = compare_avx2(new_prices, old_prices, common, res);
+    } else if (kernel == PriceComparisonKernel::SSE4_1){
+        i = compare_sse4_1(new_prices, old_prices, common, res);
+    }
+#else
+    utils::unused_variable(kernel);
+#endif
+
+    compare_scalar(new_prices, old_prices, i, common, res);
+
+    // leaf ids beyond the end of one of the arrays are unreached there
+    if (new_size > common){
+        res.new_only |= any_reached(new_prices, common, new_size);
+    } else if (old_size > common){
+        res.old_only |= any_reached(old_prices, common, old_size);
+    }
+    return res;
+}
+
+PriceComparison compare_prices(const int *new_prices, size_t new_size,
+                               const int *old_prices, size_t old_size) {
+    return compare_prices_with_kernel(best_kernel, new_prices, new_size,
+                                      old_prices, old_size);
+}
+
+
+static unique_ptr<ofstream> recording_file;
+static size_t num_pairs_to_record = 0;
+
+void start_recording_price_comparisons(const string &file_name, size_t max_pairs) {
+    recording_file = unique_ptr<ofstream>(new ofstream(file_name));
+    if (!*recording_file){
+        cerr << "Could not open " << file_name << " for recording price comparisons" << endl;
+        utils::exit_with(utils::ExitCode::SEARCH_CRITICAL_ERROR);
+    }
+    num_pairs_to_record = max_pairs;
+    cout << "recording up to " << max_pairs << " price comparisons in "
+         << file_name << endl;
+}
+
+bool is_recording_price_comparisons() {
+    return num_pairs_to_record > 0;
+}
+
+static void write_prices(ofstream &out, const int *prices, size_t size) {
+    out << size;
+    for (size_t i = 0; i < size; ++i){
+        out << ' ' << prices[i];
+    }
+}
+
+void record_price_comparison(const int *new_prices, size_t new_size,
+                             const int *old_prices, size_t old_size) {
+    assert(is_recording_price_comparisons());
+    write_prices(*recording_file, new_prices, new_size);
+    *recording_file << ' ';
+    write_prices(*recording_file, old_prices, old_size);
+    *recording_file << '\n';
+    if (--num_pairs_to_record == 0){
+        recording_file.reset();
+    }
+}
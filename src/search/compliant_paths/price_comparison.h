@@ -0,0 +1,67 @@
+#ifndef PRICE_COMPARISON_H
+#define PRICE_COMPARISON_H
+
+#include <cstddef>
+#include <string>
+
+/*
+  Result of comparing the dense prices of one leaf factor of a new and an
+  old decoupled state, both indexed by leaf id with -1 (INF) for unreached
+  leaf states. Advantages are old price - new price over the leaf states
+  reached in both; the min values are INT_MAX if no such leaf state exists.
+*/
+struct PriceComparison {
+    // some leaf state is only reached in the new / old state
+    bool new_only;
+    bool old_only;
+    int max_advantage;
+    int max_disadvantage;
+    int min_advantage;
+    int min_disadvantage;
+
+    bool operator==(const PriceComparison &other) const;
+};
+
+enum class PriceComparisonKernel {
+    SCALAR,
+    SSE4_1,
+    AVX2
+};
+
+/*
+  Compares the price arrays in a single pass. On x86 with GCC or Clang, the
+  AVX2 and SSE4.1 kernels are compiled independently of the target flags of
+  the build and the best one supported by the CPU is selected at runtime.
+  Otherwise, the scalar loop is used.
+*/
+extern PriceComparison compare_prices(const int *new_prices, size_t new_size,
+                                      const int *old_prices, size_t old_size);
+
+// the kernel used by compare_prices()
+extern PriceComparisonKernel get_price_comparison_kernel();
+
+extern bool is_price_comparison_kernel_supported(PriceComparisonKernel kernel);
+
+extern const char *get_price_comparison_kernel_name(PriceComparisonKernel kernel);
+
+// kernel must be supported, used to compare the kernels in benchmarks
+extern PriceComparison compare_prices_with_kernel(
+    PriceComparisonKernel kernel,
+    const int *new_prices, size_t new_size,
+    const int *old_prices, size_t old_size);
+
+/*
+  Recording of the price arrays passed to compare_prices() in dominance
+  checks, replayed by benchmarks/price_comparison_benchmark. Every pair is
+  written as one line "new_size new_prices... old_size old_prices...".
+  At most max_pairs pairs are recorded.
+*/
+extern void start_recording_price_comparisons(const std::string &file_name,
+                                              size_t max_pairs);
+
+extern bool is_recording_price_comparisons();
+
+extern void record_price_comparison(const int *new_prices, size_t new_size,
+                                    const int *old_prices, size_t old_size);
+
+#endif
@@ -0,0 +1,178 @@
+#include "price_vector.h"
+
+#include <algorithm>
+#include <cassert>
+
+using namespace std;
+
+
+HashConsTable<PriceVector::Data, PriceVector::DataHash, PriceVector::DataEqual> PriceVector::table;
+
+size_t PriceVector::DataHash::operator()(const Data &data) const {
+    utils::HashState hash_state;
+    utils::feed(hash_state, static_cast<uint64_t>(data.size));
+    utils::feed(hash_state, static_cast<int>(data.compact));
+    utils::feed(hash_state, data.values);
+    for (const auto &run : data.runs){
+        utils::feed(hash_state, run.first);
+    }
+    return hash_state.get_hash64();
+}
+
+bool PriceVector::DataEqual::operator()(const Data &lhs, const Data &rhs) const {
+    // compact() is deterministic, so equal prices have equal representations
+    return lhs.size == rhs.size && lhs.compact == rhs.compact &&
+           lhs.values == rhs.values && lhs.runs == rhs.runs;
+}
+
+
+int PriceVector::get_compact(size_t leaf_id) const {
+    assert(data && data->compact && leaf_id < data->size);
+    const vector<pair<uint32_t, uint32_t>> &runs = data->runs;
+    // the last run starting at or before leaf_id; the sentinel is never found
+    auto it = upper_bound(runs.begin(), runs.end() - 1, leaf_id,
+                          [](size_t id, const pair<uint32_t, uint32_t> &run) {
+                              return id < run.first;
+                          });
+    if (it == runs.begin()){
+        return CompliantPathGraph::INF;
+    }
+    --it;
+    size_t offset = leaf_id - it->first;
+    if (offset < (it + 1)->second - it->second){
+        return data->values[it->second + offset];
+    }
+    return CompliantPathGraph::INF;
+}
+
+PriceVector::Data &PriceVector::get_writable_data() {
+    if (!data){
+        data = make_shared<Data>();
+    } else if (data->compact){
+        shared_ptr<Data> dense = make_shared<Data>();
+        dense->values = get_dense();
+        dense->size = data->size;
+        data = move(dense);
+    } else if (data.use_count() > 1){
+        data = make_shared<Data>(*data);
+    }
+    assert(data.use_count() == 1 && !data->compact);
+    return *data;
+}
+
+void PriceVector::set(size_t leaf_id, int price) {
+    Data &d = get_writable_data();
+    if (leaf_id >= d.size){
+        d.values.resize(leaf_id + 1, CompliantPathGraph::INF);
+        d.size = leaf_id + 1;
+    }
+    d.values[leaf_id] = price;
+}
+
+void PriceVector::reduce_by(int cost) {
+    if (empty()){
+        return;
+    }
+    Data &d = get_writable_data();
+    for (int &price : d.values){
+        if (price != CompliantPathGraph::INF){
+            price -= cost;
+            assert(price >= 0);
+        }
+    }
+}
+
+void PriceVector::compact() {
+    if (!data || data->compact){
+        return;
+    }
+    const vector<int> &dense = data->values;
+
+    shared_ptr<Data> comp = make_shared<Data>();
+    comp->size = data->size;
+    comp->compact = true;
+    bool in_run = false;
+    for (size_t id = 0; id < dense.size(); ++id){
+        if (dense[id] == CompliantPathGraph::INF){
+            in_run = false;
+            continue;
+        }
+        if (!in_run){
+            comp->runs.emplace_back(id, comp->values.size());
+            in_run = true;
+        }
+        comp->values.push_back(dense[id]);
+    }
+    comp->runs.emplace_back(comp->size, comp->values.size());
+
+    size_t compact_bytes = comp->values.size() * sizeof(int) +
+            comp->runs.size() * sizeof(pair<uint32_t, uint32_t>);
+    if (compact_bytes < dense.size() * sizeof(int)){
+        comp->values.shrink_to_fit();
+        comp->runs.shrink_to_fit();
+        data = move(comp);
+    }
+}
+
+void PriceVector::intern() {
+    if (data){
+        data = table.intern(data);
+    }
+}
+
+bool PriceVector::operator==(const PriceVector &other) const {
+    if (data == other.data){
+        return true;
+    }
+    if (size() != other.size()){
+        return false;
+    }
+    if (!is_compact() && !other.is_compact()){
+        return data->values == other.data->values;
+    }
+    for (size_t id = 0; id < size(); ++id){
+        if ((*this)[id] != other[id]){
+            return false;
+        }
+    }
+    return true;
+}
+
+vector<int> PriceVector::get_dense() const {
+    if (!data){
+        return vector<int>();
+    }
+    if (!data->compact){
+        return data->values;
+    }
+    vector<int> dense(data->size, CompliantPathGraph::INF);
+    for (size_t r = 0; r + 1 < data->runs.size(); ++r){
+        uint32_t first = data->runs[r].first;
+        for (uint32_t i = data->runs[r].second; i < data->runs[r + 1].second; ++i){
+            dense[first + i - data->runs[r].second] = data->values[i];
+        }
+    }
+    return dense;
+}
+
+size_t PriceVector::get_memory_footprint() const {
+    size_t num_bytes = sizeof(PriceVector);
+    if (data){
+        size_t shared_bytes = sizeof(Data);
+        shared_bytes += data->values.capacity() * sizeof(int);
+        shared_bytes += data->runs.capacity() * sizeof(pair<uint32_t, uint32_t>);
+        num_bytes += shared_bytes / data.use_count();
+    }
+    return num_bytes;
+}
+
+void feed(utils::HashState &hash_state, const PriceVector &prices) {
+    utils::feed(hash_state, static_cast<uint64_t>(prices.size()));
+    for (size_t id = 0; id < prices.size(); ++id){
+        utils::feed(hash_state, prices[id]);
+    }
+}
+
+void PriceVector::print_statistics() {
+    table.print_statistics("price vectors");
+}
@@ -0,0 +1,135 @@
+#ifndef PRICE_VECTOR_H
+#define PRICE_VECTOR_H
+
+#include "compliant_path_graph.h"
+#include "shared_leaf_data.h"
+
+#include "../utils/hash.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/*
+  The prices of the reached leaf states of a single leaf factor, indexed by
+  the dense leaf ids of ExplicitStateCPG::leaf_state_id_map. Unreached leaf
+  states have price CompliantPathGraph::INF.
+
+  Copies of a PriceVector share their data, which is only copied once one of
+  them is modified (copy-on-write). Since most center actions do not touch
+  most of the leaves, the prices of a decoupled state and its successors
+  mostly share the same per-factor data.
+
+  A vector can additionally be compacted into runs of consecutive reached
+  leaf ids, which is used for the decoupled states kept in the CPGStorage.
+  Modifying a compacted vector converts it back to the dense representation.
+
+  Finally, intern() makes equal price vectors of different decoupled states
+  share their data, see HashConsTable.
+*/
+class PriceVector {
+    struct Data {
+        // dense: the price of every leaf id < size
+        // compact: the prices of the reached leaf ids, run after run
+        std::vector<int> values;
+        // compact only: first leaf id and offset into values of each run,
+        // followed by a sentinel entry (size, values.size())
+        std::vector<std::pair<std::uint32_t, std::uint32_t>> runs;
+        size_t size;
+        bool compact;
+
+        Data() : size(0), compact(false) {}
+    };
+
+    struct DataHash {
+        std::size_t operator()(const Data &data) const;
+    };
+
+    struct DataEqual {
+        bool operator()(const Data &lhs, const Data &rhs) const;
+    };
+
+    std::shared_ptr<Data> data;
+
+    static HashConsTable<Data, DataHash, DataEqual> table;
+
+    int get_compact(size_t leaf_id) const;
+
+    // makes sure that data is dense and not shared with any other vector
+    Data &get_writable_data();
+
+public:
+
+    PriceVector() = default;
+
+    // number of leaf ids covered (the dense size)
+    size_t size() const {
+        return data ? data->size : 0;
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    int operator[](size_t leaf_id) const {
+        if (!data || leaf_id >= data->size){
+            return CompliantPathGraph::INF;
+        }
+        if (!data->compact){
+            return data->values[leaf_id];
+        }
+        return get_compact(leaf_id);
+    }
+
+    void set(size_t leaf_id, int price);
+
+    // reduce all prices != INF by cost
+    void reduce_by(int cost);
+
+    // switch to the run representation if that needs less memory
+    void compact();
+
+    bool is_compact() const {
+        return data && data->compact;
+    }
+
+    // the size() dense prices, nullptr if the vector is empty or compact
+    const int *get_dense_data() const {
+        return (data && !data->compact) ? data->values.data() : nullptr;
+    }
+
+    // share the data with all equal interned vectors
+    void intern();
+
+    bool shares_data_with(const PriceVector &other) const {
+        return data == other.data;
+    }
+
+    /*
+      Vectors with the same identity are equal. Holding the identity keeps
+      the data alive, so it is never reused for different prices. Empty
+      vectors have no identity.
+    */
+    std::shared_ptr<const void> get_identity() const {
+        return data;
+    }
+
+    bool operator==(const PriceVector &other) const;
+
+    // the dense representation, entries beyond size() are omitted
+    std::vector<int> get_dense() const;
+
+    // returns the number of bytes of this vector, data that is shared
+    // between several vectors is split evenly among them
+    size_t get_memory_footprint() const;
+
+    static void print_statistics();
+};
+
+/*
+  Hashes the same sequence as utils::feed on the dense std::vector<int>,
+  independent of the representation of the vector.
+*/
+void feed(utils::HashState &hash_state, const PriceVector &prices);
+
+#endif
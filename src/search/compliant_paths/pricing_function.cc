@@ -1,10 +1,12 @@
 #include "pricing_function.h"
 
 #include "cpg_storage.h"
+#include "../algorithms/priority_queues.h"
 #include "../factoring.h"
 #include "../globals.h"
 #include "../operator.h"
 #include "effective_prices.h"
+#include "price_comparison.h"
 #include "pruning_options.h"
 #include "../state_registry.h"
 #include "../symmetries/decoupled_permutation.h"
@@ -37,7 +39,7 @@ Prices& Prices::operator=(Prices &&other) {
 
 void Prices::resize() {
     number_states = vector<size_t>(g_leaves.size(), 0);
-    prices = vector<vector<int> >(g_leaves.size());
+    prices = vector<PriceVector>(g_leaves.size());
     goal_cost = vector<int>(g_leaves.size(), INF);
 }
 
@@ -49,12 +51,7 @@ void Prices::reduce_cost_by(LeafFactorID factor, int cost) {
         goal_cost[factor] -= cost;
         assert(goal_cost[factor] >= 0);
     }
-    for (size_t id = 0; id < prices[factor].size(); ++id){
-        if (prices[factor][id] != INF){
-            prices[factor][id] -= cost;
-            assert(prices[factor][id] >= 0);
-        }
-    }
+    prices[factor].reduce_by(cost);
 }
 
 bool Prices::add_state(LeafStateHash id, LeafFactorID factor, int cost) {
@@ -68,11 +65,9 @@ bool Prices::add_state(LeafStateHash id, LeafFactorID factor, int cost) {
     }
     size_t leaf_id = leaf_state_id_map[factor][id];
 
-    if (leaf_id >= prices[factor].size()){
-        prices[factor].resize(leaf_id + 1, INF);
-    }
-    if (prices[factor][leaf_id] == INF){
-        prices[factor][leaf_id] = cost;
+    int old_cost = prices[factor][leaf_id];
+    if (old_cost == INF){
+        prices[factor].set(leaf_id, cost);
         ++number_states[factor];
         if (!g_goals_per_factor[factor].empty() && is_leaf_goal_state(id, factor)){
             if (goal_cost[factor] == INF || goal_cost[factor] > cost){
@@ -80,8 +75,8 @@ bool Prices::add_state(LeafStateHash id, LeafFactorID factor, int cost) {
             }
         }
         return true;
-    } else if (prices[factor][leaf_id] > cost){
-        prices[factor][leaf_id] = cost;
+    } else if (old_cost > cost){
+        prices[factor].set(leaf_id, cost);
         if (!g_goals_per_factor[factor].empty() && is_leaf_goal_state(id, factor)){
             if (goal_cost[factor] > cost){
                 goal_cost[factor] = cost;
@@ -113,6 +108,12 @@ void Prices::update(const GlobalState &base_state) {
     cout << "+++++++++++++++ STARTING UPDATE" << endl;
 #endif
 
+    reset_center_applicability_cache();
+
+    // Dijkstra-style propagation starting from all reached leaf states,
+    // so only leaf states whose price decreased are expanded (again)
+    priority_queues::AdaptiveQueue<LeafStateHash> queue;
+
     for (LeafFactorID factor(0); factor < g_leaves.size(); ++factor){
 
         // skip fork leaves that don't have a goal!
@@ -122,65 +123,43 @@ void Prices::update(const GlobalState &base_state) {
 
 #ifdef DEBUG_SEARCH
         cout << "       starting UPDATE for leaf factor " << factor << endl;
-        const vector<PricesInfo*> &achieved_facts = new_tag.get_facts(factor);
-        for (int i = 0; i < achieved_facts.size(); i++){
-            if (achieved_facts[i] == 0){
-                continue;
-            }
-            lookup_leaf_state(LeafStateID(i, factor)).dump_pddl();
-        }
-        cout << "       " << new_tag.get_number_states(factor) << " fact(s) initially true in leaf factor " << factor << endl;
+        cout << "       " << get_number_states(factor) << " leaf state(s) initially reached in leaf factor " << factor << endl;
 #endif
 
-        vector<int> best_prices(g_state_registry->size(factor), numeric_limits<int>::max());
-
-        bool change = true;
-
-        while (change) {
-
-            change = false;
-
-            size_t num_states_handled = 0;
-
-            for (LeafStateHash id(0); id < g_state_registry->size(factor); ++id){
-
-                if (has_leaf_state(id, factor)){
-
-                    int cost = get_cost_of_state(id, factor);
-                    if (best_prices[id] <= cost){
-                        continue;
-                    }
+        bool is_ifork_leaf = g_factoring->is_ifork_leaf(factor);
 
-                    best_prices[id] = cost;
+        queue.clear();
+        size_t num_states = get_number_states(factor);
+        for (LeafStateHash id(0); num_states > 0; ++id){
+            if (has_leaf_state(id, factor)){
+                --num_states;
+                queue.push(get_cost_of_state(id, factor), id);
+            }
+        }
 
-                    assert(id < leaf_state_successors[factor].size());
+        while (!queue.empty()){
+            auto [cost, id] = queue.pop();
+            if (get_cost_of_state(id, factor) < cost){
+                // the price of id decreased after this entry was pushed
+                continue;
+            }
 
-                    for (size_t o = 0; o < leaf_state_successors[factor][id].size(); ++o){
-                        const Operator &op = g_operators[leaf_state_successors[factor][id][o].first];
-                        // TODO what about caching applicability per update?
-                        if (g_factoring->is_ifork_leaf(factor) || op.is_center_applicable(base_state)){
-                            LeafStateHash successor = leaf_state_successors[factor][id][o].second;
-                            change |= add_state(successor, factor,
-                                                cost + get_adjusted_action_cost(op, cost_type));
-                        }
-                    }
+            assert(id < leaf_state_successors[factor].size());
 
-                    if (++num_states_handled == get_number_states(factor)){
-                        break;
+            for (const auto &[op_id, successor] : leaf_state_successors[factor][id]){
+                if (is_ifork_leaf || is_center_applicable_cached(op_id, base_state)){
+                    int succ_cost = cost + get_adjusted_action_cost(g_operators[op_id], cost_type);
+                    if (add_state(successor, factor, succ_cost)){
+                        queue.push(succ_cost, successor);
                     }
-
-                    // TODO probably reintroduce this for optimal search again
-                    // keep in mind to change the pruning methods accordingly! + change the corresponding expression in PathPrices
-                    // when introducing this, also have a shortcut at the beginning of the outmost for loop
-//                 if (g_factoring->get_search_type() == SAT && !g_factoring->has_successors(factor) && get_goal_cost(factor) >= 0){
-//                     // in satisficing search => stop once a goal is reachable in fork-leaves
-//                     change = false;
-//                     break;
-//                 }
                 }
             }
         }
 
+        // TODO probably reintroduce this for optimal search again
+        // keep in mind to change the pruning methods accordingly! + change the corresponding expression in PathPrices
+        // in satisficing search => stop once a goal is reachable in fork-leaves
+
 #ifdef DEBUG_SEARCH
     cout << "   UPDATE for leaf factor " << factor << " finished" << endl;
 #endif
@@ -200,6 +179,10 @@ DOMINANCE Prices::check_dominance(const GlobalState &other, int g_advantage, DOM
 
     const Prices *other_cpg = &cpg_storage->cpgs[other];
 
+    if (g_advantage == 0 && shares_all_prices_with(*other_cpg)){
+        return DOMINANCE::EQUAL;
+    }
+
     bool dominated = true;
     bool dominates = true;
 
@@ -276,6 +259,43 @@ DOMINANCE Prices::check_dominance(const GlobalState &other, int g_advantage, DOM
         int max_disadvantage = 0;
         int min_advantage = numeric_limits<int>::max();
         int min_disadvantage = numeric_limits<int>::max();
+        if (prices[factor].shares_data_with(other_cpg->prices[factor])){
+            // identical prices, neither an advantage nor a disadvantage
+            number_new_states = 0;
+            number_old_states = 0;
+        } else if (!prices[factor].is_compact() && !other_cpg->prices[factor].is_compact()){
+            // both dense, compare the price arrays in a single (vectorized) pass
+            if (is_recording_price_comparisons()){
+                record_price_comparison(
+                    prices[factor].get_dense_data(), prices[factor].size(),
+                    other_cpg->prices[factor].get_dense_data(), other_cpg->prices[factor].size());
+            }
+            PriceComparison comparison = compare_prices(
+                prices[factor].get_dense_data(), prices[factor].size(),
+                other_cpg->prices[factor].get_dense_data(), other_cpg->prices[factor].size());
+            if (comparison.new_only){
+                dominated = false;
+                if (!dominates ||
+                        needed == DOMINANCE::DOMINATED ||
+                        pruning->use_exact_duplicate_checking()){
+                    return DOMINANCE::NONE;
+                }
+            }
+            if (comparison.old_only){
+                dominates = false;
+                if (!dominated ||
+                        needed == DOMINANCE::DOMINATES ||
+                        pruning->use_exact_duplicate_checking()){
+                    return DOMINANCE::NONE;
+                }
+            }
+            max_advantage = comparison.max_advantage;
+            max_disadvantage = comparison.max_disadvantage;
+            min_advantage = comparison.min_advantage;
+            min_disadvantage = comparison.min_disadvantage;
+            number_new_states = 0;
+            number_old_states = 0;
+        }
         while (number_new_states + number_old_states > 0){
             assert(id < g_state_registry->size(factor));
             if (has_leaf_state(id, factor)){
@@ -383,6 +403,34 @@ DOMINANCE Prices::check_dominance(const GlobalState &other, int g_advantage, DOM
     return DOMINANCE::NONE;
 }
 
+DominanceSignature Prices::get_dominance_signature() const {
+    DominanceSignature signature(g_leaves.size());
+    for (LeafFactorID factor(0); factor < g_leaves.size(); ++factor){
+        // goal costs are only compared in check_dominance() for factors with goals
+        int goal_cost = g_goals_per_factor[factor].empty() ? CompliantPathGraph::INF : get_goal_cost(factor);
+        signature.set_number_states(factor, get_number_states(factor), goal_cost);
+        const PriceVector &factor_prices = prices[factor];
+        for (size_t id = 0; id < factor_prices.size(); ++id){
+            if (factor_prices[id] != CompliantPathGraph::INF){
+                signature.add_leaf_state(factor, id);
+            }
+        }
+    }
+    return signature;
+}
+
+bool Prices::shares_all_prices_with(const Prices &other) const {
+    if (prices.size() != other.prices.size()){
+        return false;
+    }
+    for (LeafFactorID factor(0); factor < prices.size(); ++factor){
+        if (!prices[factor].shares_data_with(other.prices[factor])){
+            return false;
+        }
+    }
+    return true;
+}
+
 void Prices::apply_center_op_to_leaves(const Prices &old_cpg, const Operator &op) {
     // TODO store some tree that captures which leaf states satisfy a certain leaf condition
     // then run only over the states that satisfy the leaf precondition of op.
@@ -460,8 +508,7 @@ bool Prices::has_leaf_state(LeafStateHash id, LeafFactorID factor) const {
     if (id >= leaf_state_id_map[factor].size() || leaf_state_id_map[factor][id] == -1){
         return false;
     }
-    size_t leaf_id = leaf_state_id_map[factor][id];
-    return leaf_id < prices[factor].size() && prices[factor][leaf_id] != INF;
+    return prices[factor][leaf_state_id_map[factor][id]] != INF;
 }
 
 int Prices::get_cost_of_state(LeafStateHash id, LeafFactorID factor) const {
@@ -473,6 +520,10 @@ size_t Prices::get_number_states(LeafFactorID factor) const {
     return number_states[factor];
 }
 
+shared_ptr<const void> Prices::get_prices_identity(LeafFactorID factor) const {
+    return prices[factor].get_identity();
+}
+
 int Prices::get_goal_cost(LeafFactorID factor) const {
     return goal_cost[factor];
 }
@@ -516,7 +567,19 @@ void Prices::populate_cost_of_leaf_facts(function<void(int, int, int)> f) const
     }
 }
 
+void Prices::prepare_for_storage() {
+    for (LeafFactorID factor(0); factor < g_leaves.size(); ++factor){
+        if (pruning->use_compact_prices()){
+            prices[factor].compact();
+        }
+        if (pruning->use_hash_consing()){
+            prices[factor].intern();
+        }
+    }
+}
+
 void Prices::store_new_cpg(const GlobalState &state) {
+    prepare_for_storage();
     cpg_storage->store_cpg(state, *this);
 }
 
@@ -560,7 +623,7 @@ void Prices::dump() const {
 
 void Prices::apply_symmetry_permutation(const symmetries::LeavesPermutation &per) {
     // Copy prices and reinitialize affected factors
-    vector<vector<int> > old_prices(g_leaves.size());
+    vector<PriceVector> old_prices(g_leaves.size());
     vector<size_t> old_number_states(g_leaves.size());
 
 #ifndef NDEBUG
@@ -573,7 +636,7 @@ void Prices::apply_symmetry_permutation(const symmetries::LeavesPermutation &per
         old_prices[factor] = prices[factor];
 
         number_states[factor] = 0;
-        prices[factor] = vector<int>();
+        prices[factor] = PriceVector();
         goal_cost[factor] = INF;
     }
 
@@ -596,8 +659,7 @@ void Prices::apply_symmetry_permutation(const symmetries::LeavesPermutation &per
             }
 
             size_t leaf_state = leaf_state_id_map[from_factor][id];
-            if (leaf_state >= old_prices[from_factor].size() ||
-                    old_prices[from_factor][leaf_state] == INF){
+            if (old_prices[from_factor][leaf_state] == INF){
                 continue;
             }
 
@@ -629,10 +691,11 @@ size_t Prices::get_memory_footprint() const {
         num_bytes += sizeof(vector<size_t>);
         num_bytes += g_leaves.size() * sizeof(size_t);
 
-        num_bytes += sizeof(vector<vector<int> >);
-        num_bytes += g_leaves.size() * sizeof(vector<int>);
+        // per-factor prices shared with other decoupled states are
+        // only counted proportionally, see PriceVector
+        num_bytes += sizeof(vector<PriceVector>);
         for (LeafFactorID factor(0); factor < g_leaves.size(); ++factor){
-            num_bytes += prices[factor].size() * sizeof(int);
+            num_bytes += prices[factor].get_memory_footprint();
         }
     }
     return num_bytes;
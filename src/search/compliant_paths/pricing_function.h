@@ -2,6 +2,7 @@
 #define PRICING_FUNCTION_H
 
 #include "explicit_state_cpg.h"
+#include "price_vector.h"
 #include "../leaf_state_id.h"
 #include "../symmetries/symmetry_cpg.h"
 
@@ -27,7 +28,7 @@ class Prices : public ExplicitStateCPG, public symmetries::SymmetryCPG {
 
 protected:
 
-    std::vector<std::vector<int> > prices;
+    std::vector<PriceVector> prices;
 
     std::vector<size_t> number_states;
 
@@ -41,6 +42,13 @@ protected:
 
     void update(const GlobalState &new_center_state);
 
+    // compact and intern the per-factor prices, depending on the pruning options
+    void prepare_for_storage();
+
+    // true if all per-factor prices are shared with other, which implies
+    // that both are equal
+    bool shares_all_prices_with(const Prices &other) const;
+
     virtual std::unique_ptr<CompliantPathGraph> get_successor_via_center_action(const GlobalState &new_center_state,
                                                                                 const Operator &op) const override;
 
@@ -50,6 +58,8 @@ protected:
 
     virtual bool is_hypercube_covered(const GlobalState &base_state, int curr_number_duplicates) const override;
 
+    virtual DominanceSignature get_dominance_signature() const override;
+
 public:
 
     Prices(){};
@@ -69,6 +79,8 @@ public:
 
     virtual size_t get_number_states(LeafFactorID factor) const override;
 
+    virtual std::shared_ptr<const void> get_prices_identity(LeafFactorID factor) const override;
+
     virtual void populate_reached_leaf_facts(std::function<void(int, int)> f) const override;
 
     virtual void populate_cost_of_leaf_facts(std::function<void(int, int, int)> f) const override;
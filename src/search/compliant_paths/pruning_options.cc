@@ -5,6 +5,7 @@
 #include "../factoring.h"
 #include "../option_parser.h"
 #include "../plugin.h"
+#include "price_comparison.h"
 #include "simulation_relation.h"
 
 
@@ -13,6 +14,8 @@ using namespace std;
 
 bool PruningOptions::ignore_current_search_state = false;
 
+static const size_t MAX_RECORDED_PRICE_COMPARISONS = 100000;
+
 
 
 PruningOptions::PruningOptions(const Options &opts)
@@ -25,7 +28,10 @@ PruningOptions::PruningOptions(const Options &opts)
                       exploit_leaf_invertibility(opts.get<bool>("exploit_leaf_invertibility")),
                       irrelevance(opts.get<IRRELEVANCE>("irrelevance")),
                       do_simulation(opts.get<bool>("simulation")),
-                      goal_price_propagation(opts.get<bool>("goal_price_propagation")) {
+                      goal_price_propagation(opts.get<bool>("goal_price_propagation")),
+                      compact_prices(opts.get<bool>("compact_prices")),
+                      hash_consing(opts.get<bool>("hash_consing")),
+                      dominance_signatures(opts.get<bool>("dominance_signatures")) {
 
     switch (pruning_type){
     case PRUNING_TYPE::DOMINANCE: cout << "using dominance pruning" << endl; break;
@@ -50,6 +56,19 @@ PruningOptions::PruningOptions(const Options &opts)
     if (hypercube_pruning){
         cout << "performing hypercube pruning" << endl;
     }
+    if (compact_prices){
+        cout << "storing compact price vectors" << endl;
+    }
+    if (hash_consing){
+        cout << "sharing equal per-factor prices across decoupled states" << endl;
+    }
+    if (dominance_signatures){
+        cout << "filtering dominance candidates by signatures" << endl;
+    }
+    if (opts.contains("record_price_comparisons")){
+        start_recording_price_comparisons(opts.get<string>("record_price_comparisons"),
+                                          MAX_RECORDED_PRICE_COMPARISONS);
+    }
 }
 
 void PruningOptions::verify_options() {
@@ -205,6 +224,30 @@ void PruningOptions::add_options_to_parser(OptionParser &parser){
     parser.add_option<bool>("simulation",
                             "perform simulation dominance pruning", "false");
 
+    parser.add_option<bool>("compact_prices",
+                            "store the prices of generated decoupled states as runs of reached "
+                            "leaf states instead of dense vectors (optimal search with explicit leaves only)",
+                            "false");
+
+    parser.add_option<bool>("hash_consing",
+                            "share equal per-factor prices (or reachable leaf states) between "
+                            "decoupled states, equal ones are then detected without comparing them "
+                            "(explicit leaves only)",
+                            "false");
+
+    parser.add_option<bool>("dominance_signatures",
+                            "skip dominance checks against decoupled states whose number of reached "
+                            "leaf states, reachable goals, or summary of reached leaf states rule out "
+                            "dominance in either direction (explicit leaves only). This computes a "
+                            "signature for every generated decoupled state by a pass over its prices",
+                            "false");
+
+    parser.add_option<string>("record_price_comparisons",
+                              "write the first 100000 pairs of dense price vectors compared in "
+                              "dominance checks to this file, for replaying them with "
+                              "benchmarks/price_comparison_benchmark",
+                              OptionParser::NONE);
+
     vector<string> irr_options({"NO", "STATES", "TRANSITIONS"});
     parser.add_enum_option<IRRELEVANCE>("irrelevance",
                            irr_options,
@@ -61,6 +61,18 @@ class PruningOptions {
     
     bool goal_price_propagation;
 
+    // store the prices of generated decoupled states as runs of
+    // reached leaf states, see PriceVector
+    bool compact_prices;
+
+    // share equal per-factor prices / reachable sets of generated
+    // decoupled states, see HashConsTable
+    bool hash_consing;
+
+    // rule out candidates for dominance checks by comparing cheap
+    // signatures of decoupled states, see DominanceSignature
+    bool dominance_signatures;
+
     
     static bool ignore_current_search_state; // TODO: get rid of this hack
 
@@ -74,7 +86,10 @@ public:
                        exploit_leaf_invertibility(true),
                        irrelevance(IRRELEVANCE::NO),
                        do_simulation(false), 
-                       goal_price_propagation(false) {}
+                       goal_price_propagation(false),
+                       compact_prices(false),
+                       hash_consing(false),
+                       dominance_signatures(false) {}
 
     PruningOptions(const options::Options &opts);
 
@@ -132,6 +147,18 @@ public:
         return do_simulation;
     }
 
+    bool use_compact_prices() const {
+        return compact_prices;
+    }
+
+    bool use_hash_consing() const {
+        return hash_consing;
+    }
+
+    bool use_dominance_signatures() const {
+        return dominance_signatures;
+    }
+
     
     static void set_ignore_current_state() {
         ignore_current_search_state = true;
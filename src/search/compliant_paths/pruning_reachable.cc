@@ -31,7 +31,7 @@ PruningReachable& PruningReachable::operator=(PruningReachable &&other) {
 }
 
 void PruningReachable::resize() {
-    reachable = vector<boost::dynamic_bitset<> >(g_leaves.size());
+    reachable = vector<SharedLeafData<boost::dynamic_bitset<> > >(g_leaves.size());
     goal_reached.resize(g_leaves.size(), false);
 }
 
@@ -136,6 +136,7 @@ void PruningReachable::compute_frontier() {
 }
 
 void PruningReachable::store_new_cpg(const GlobalState &state) {
+    intern_reachable();
     cpg_storage->store_cpg(state, *this);
 }
 
@@ -34,7 +34,7 @@ Reachable& Reachable::operator=(Reachable &&other) {
 }
 
 void Reachable::resize() {
-    reachable = vector<boost::dynamic_bitset<> >(g_leaves.size());
+    reachable = vector<SharedLeafData<boost::dynamic_bitset<> > >(g_leaves.size());
     goal_reached.resize(g_leaves.size(), false);
 }
 
@@ -51,17 +51,18 @@ bool Reachable::add_state(LeafStateHash id, LeafFactorID factor) {
     }
     size_t leaf_id = leaf_state_id_map[factor][id];
 
-    if (leaf_id >= reachable[factor].size()){
-        reachable[factor].resize(leaf_id + 1, false);
+    if (leaf_id < reachable[factor]->size() && (*reachable[factor])[leaf_id]){
+        return false;
     }
-    if (!reachable[factor][leaf_id]){
-        reachable[factor][leaf_id] = true;
-        if (!g_goals_per_factor[factor].empty() && is_leaf_goal_state(id, factor)){
-            goal_reached[factor] = true;
-        }
-        return true;
+    boost::dynamic_bitset<> &reached = reachable[factor].get_writable();
+    if (leaf_id >= reached.size()){
+        reached.resize(leaf_id + 1, false);
     }
-    return false;
+    reached[leaf_id] = true;
+    if (!g_goals_per_factor[factor].empty() && is_leaf_goal_state(id, factor)){
+        goal_reached[factor] = true;
+    }
+    return true;
 }
 
 unique_ptr<CompliantPathGraph> Reachable::get_successor_via_center_action(const GlobalState &new_center_state,
@@ -84,6 +85,8 @@ void Reachable::update(const GlobalState &base_state) {
     cout << "+++++++++++++++ STARTING UPDATE" << endl;
 #endif
 
+    reset_center_applicability_cache();
+
     for (LeafFactorID factor(0); factor < g_leaves.size(); ++factor){
 
         if (is_leaf_state_space_scc[factor]){
@@ -156,7 +159,7 @@ void Reachable::update(const GlobalState &base_state) {
                     }
                     for (size_t o = 0; o < leaf_state_successors[factor][id].size(); ++o){
                         if (g_factoring->is_ifork_leaf(factor) ||
-                                g_operators[leaf_state_successors[factor][id][o].first].is_center_applicable(base_state)){
+                                is_center_applicable_cached(leaf_state_successors[factor][id][o].first, base_state)){
                             if(add_state(leaf_state_successors[factor][id][o].second, factor)) {
                                 ++added;
                             }
@@ -198,7 +201,7 @@ void Reachable::update(const GlobalState &base_state) {
                     for (OperatorID op_id : applicable_ops){
                         const Operator &op = g_operators[op_id];
 
-                        if (op.has_effect_on(factor) && (fits_store || op.is_center_applicable(base_state))){
+                        if (op.has_effect_on(factor) && (fits_store || is_center_applicable_cached(op_id, base_state))){
 
                             LeafStateHash lid = g_state_registry->get_successor_leaf_state_hash(predecessor, op);
 
@@ -210,7 +213,7 @@ void Reachable::update(const GlobalState &base_state) {
                                 leaf_state_id_map[factor].resize(lid + 1, -1);
                             }
 
-                            if(!fits_store || op.is_center_applicable(base_state)){
+                            if(!fits_store || is_center_applicable_cached(op_id, base_state)){
                                 if (add_state(lid, factor)){
                                     ++added;
                                 }
@@ -298,24 +301,28 @@ DOMINANCE Reachable::check_dominance(const GlobalState &other, int, DOMINANCE ne
             }
             all_goals_reached = false;
         }
-        assert(reachable[factor][reachable[factor].size() - 1]);
-        assert(other_cpg->reachable[factor][other_cpg->reachable[factor].size() - 1]);
-        if (reachable[factor].size() > other_cpg->reachable[factor].size()){
+        const boost::dynamic_bitset<> &reached = *reachable[factor];
+        const boost::dynamic_bitset<> &other_reached = *other_cpg->reachable[factor];
+        assert(reached[reached.size() - 1]);
+        assert(other_reached[other_reached.size() - 1]);
+        if (reachable[factor].shares_data_with(other_cpg->reachable[factor])){
+            // identical sets of reached leaf states
+        } else if (reached.size() > other_reached.size()){
             new_is_larger = true;
             sizes_equal = false;
             need_to_check[factor] = true;
-        } else if (reachable[factor].size() < other_cpg->reachable[factor].size()){
+        } else if (reached.size() < other_reached.size()){
             new_is_smaller = true;
             sizes_equal = false;
             need_to_check[factor] = true;
         } else {
-            if (reachable[factor].is_proper_subset_of(other_cpg->reachable[factor])){
+            if (reached.is_proper_subset_of(other_reached)){
                 new_is_smaller = true;
                 sizes_equal = false;
-            } else if (other_cpg->reachable[factor].is_proper_subset_of(reachable[factor])){
+            } else if (other_reached.is_proper_subset_of(reached)){
                 new_is_larger = true;
                 sizes_equal = false;
-            } else if (other_cpg->reachable[factor] != reachable[factor]){
+            } else if (other_reached != reached){
                 // no dominance in either direction
                 return DOMINANCE::NONE;
             }
@@ -354,26 +361,28 @@ DOMINANCE Reachable::check_dominance(const GlobalState &other, int, DOMINANCE ne
         if (!need_to_check[factor]){
             continue;
         }
-        assert(reachable[factor].size() != other_cpg->reachable[factor].size());
-        if (reachable[factor].size() > other_cpg->reachable[factor].size()){
-            assert(!dominated); // implied by reachable[factor].size() > other_cpg->reachable[factor].size()
-            boost::dynamic_bitset<>::size_type index = other_cpg->reachable[factor].find_first();
+        const boost::dynamic_bitset<> &reached = *reachable[factor];
+        const boost::dynamic_bitset<> &other_reached = *other_cpg->reachable[factor];
+        assert(reached.size() != other_reached.size());
+        if (reached.size() > other_reached.size()){
+            assert(!dominated); // implied by reached.size() > other_reached.size()
+            boost::dynamic_bitset<>::size_type index = other_reached.find_first();
             while (index != boost::dynamic_bitset<>::npos){
-                if (!reachable[factor][index]){
+                if (!reached[index]){
                     // not dominates and not dominated
                     return DOMINANCE::NONE;
                 }
-                index = other_cpg->reachable[factor].find_next(index);
+                index = other_reached.find_next(index);
             }
-        } else if (reachable[factor].size() < other_cpg->reachable[factor].size()){
-            assert(!dominates); // implied by reachable[factor].size() < other_cpg->reachable[factor].size()
-            boost::dynamic_bitset<>::size_type index = reachable[factor].find_first();
+        } else if (reached.size() < other_reached.size()){
+            assert(!dominates); // implied by reached.size() < other_reached.size()
+            boost::dynamic_bitset<>::size_type index = reached.find_first();
             while (index != boost::dynamic_bitset<>::npos){
-                if (!other_cpg->reachable[factor][index]){
+                if (!other_reached[index]){
                     // not dominated and not dominates
                     return DOMINANCE::NONE;
                 }
-                index = reachable[factor].find_next(index);
+                index = reached.find_next(index);
             }
         }
     }
@@ -498,7 +507,7 @@ bool Reachable::has_leaf_state(LeafStateHash id, LeafFactorID factor) const {
         return false;
     }
     size_t leaf_id = leaf_state_id_map[factor][id];
-    return leaf_id < reachable[factor].size() && reachable[factor][leaf_id];
+    return leaf_id < reachable[factor]->size() && (*reachable[factor])[leaf_id];
 }
 
 int Reachable::get_cost_of_state(LeafStateHash id, LeafFactorID factor) const {
@@ -506,16 +515,16 @@ int Reachable::get_cost_of_state(LeafStateHash id, LeafFactorID factor) const {
     if (is_leaf_state_space_scc[factor]){
         return min_leaf_action_cost[factor];
     }
-    assert((size_t) leaf_state_id_map[factor][id] < reachable[factor].size());
+    assert((size_t) leaf_state_id_map[factor][id] < reachable[factor]->size());
     // TODO: this assumes that the initial state is not a goal state, otherwise need to return 0 for initial state e.g. for forks
-    return reachable[factor][leaf_state_id_map[factor][id]] ? min_leaf_action_cost[factor] : INF;
+    return (*reachable[factor])[leaf_state_id_map[factor][id]] ? min_leaf_action_cost[factor] : INF;
 }
 
 size_t Reachable::get_number_states(LeafFactorID factor) const {
     if (is_leaf_state_space_scc[factor]){
         return g_state_registry->size(factor);
     }
-    return reachable[factor].count();
+    return reachable[factor]->count();
 }
 
 int Reachable::get_goal_cost(LeafFactorID factor) const {
@@ -570,7 +579,16 @@ void Reachable::populate_cost_of_leaf_facts(function<void(int, int, int)> f) con
     }
 }
 
+void Reachable::intern_reachable() {
+    if (pruning->use_hash_consing()){
+        for (LeafFactorID factor(0); factor < reachable.size(); ++factor){
+            reachable[factor].intern();
+        }
+    }
+}
+
 void Reachable::store_new_cpg(const GlobalState &state) {
+    intern_reachable();
     cpg_storage->store_cpg(state, *this);
 }
 
@@ -622,7 +640,7 @@ uint64_t Reachable::get_hash() const {
 }
 
 void Reachable::apply_symmetry_permutation(const symmetries::LeavesPermutation &per) {
-    vector<boost::dynamic_bitset<> > old_reachable(reachable);
+    vector<SharedLeafData<boost::dynamic_bitset<> > > old_reachable(reachable);
 
 #ifndef NDEBUG
     boost::dynamic_bitset<> old_goal_reached(goal_reached);
@@ -632,14 +650,14 @@ void Reachable::apply_symmetry_permutation(const symmetries::LeavesPermutation &
     for (LeafFactorID factor : per.get_factors_affected()) {
         old_reachable[factor] = reachable[factor];
 
-        reachable[factor] = boost::dynamic_bitset<>();
+        reachable[factor] = SharedLeafData<boost::dynamic_bitset<> >();
         goal_reached[factor] = false;
     }
 
     for(LeafFactorID to_factor : per.get_factors_affected()) {
         LeafFactorID from_factor = per.get_from_factor(to_factor);
 
-        size_t num_states = old_reachable[from_factor].count();
+        size_t num_states = old_reachable[from_factor]->count();
         for  (LeafStateHash id(0); num_states > 0; ++id){
             assert(id < leaf_state_id_map[from_factor].size());
             if (leaf_state_id_map[from_factor][id] == -1) {
@@ -647,8 +665,8 @@ void Reachable::apply_symmetry_permutation(const symmetries::LeavesPermutation &
             }
 
             size_t leaf_state = leaf_state_id_map[from_factor][id];
-            if (leaf_state >= old_reachable[from_factor].size() ||
-                    !old_reachable[from_factor][leaf_state]){
+            if (leaf_state >= old_reachable[from_factor]->size() ||
+                    !(*old_reachable[from_factor])[leaf_state]){
                 continue;
             }
 
@@ -664,8 +682,8 @@ void Reachable::apply_symmetry_permutation(const symmetries::LeavesPermutation &
 #ifndef NDEBUG
     size_t old = 0, now = 0;
     for (size_t factor = 0; factor < g_leaves.size(); ++factor){
-        old += old_reachable[factor].count();
-        now += reachable[factor].count();
+        old += old_reachable[factor]->count();
+        now += reachable[factor]->count();
     }
     assert(old == now);
     assert(goal_reached.count() == old_goal_reached.count());
@@ -680,9 +698,11 @@ size_t Reachable::get_memory_footprint() const {
         num_bytes += (1 + g_leaves.size()) * sizeof(vector<boost::dynamic_bitset<> >);
         num_bytes += goal_reached.num_blocks() * sizeof(boost::dynamic_bitset<>::block_type);
 
-        num_bytes += sizeof(vector<boost::dynamic_bitset<> >);
+        // shared sets are only counted proportionally
+        num_bytes += sizeof(vector<SharedLeafData<boost::dynamic_bitset<> > >);
         for (LeafFactorID factor(0); factor < g_leaves.size(); ++factor){
-            num_bytes += reachable[factor].num_blocks() * sizeof(boost::dynamic_bitset<>::block_type);
+            num_bytes += reachable[factor]->num_blocks() * sizeof(boost::dynamic_bitset<>::block_type)
+                    / reachable[factor].get_num_references();
         }
     }
     return num_bytes;
@@ -3,6 +3,7 @@
 
 #include "../ext/boost/dynamic_bitset.hpp"
 #include "explicit_state_cpg.h"
+#include "shared_leaf_data.h"
 #include "../symmetries/symmetry_cpg.h"
 
 #include <vector>
@@ -25,7 +26,8 @@ class Reachable : public ExplicitStateCPG, public symmetries::SymmetryCPG {
 
 protected:
 
-    std::vector<boost::dynamic_bitset<> > reachable;
+    // shared copy-on-write with other decoupled states, see SharedLeafData
+    std::vector<SharedLeafData<boost::dynamic_bitset<> > > reachable;
 
     boost::dynamic_bitset<> goal_reached;
 
@@ -36,6 +38,9 @@ protected:
 
     void apply_center_op_to_leaves(const Reachable &old_cpg, const Operator &op);
 
+    // intern the per-factor reachable sets if hash consing is enabled
+    void intern_reachable();
+
     virtual std::unique_ptr<CompliantPathGraph> get_successor_via_center_action(const GlobalState &new_center_state,
                                                                                 const Operator &op) const override;
 
@@ -0,0 +1,166 @@
+#ifndef SHARED_LEAF_DATA_H
+#define SHARED_LEAF_DATA_H
+
+#include "../utils/hash.h"
+
+#include <algorithm>
+#include <cassert>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+/*
+  Hash-consing table for per-factor data of decoupled states: equal data is
+  only stored once and all decoupled states refer to the same object.
+
+  The table only keeps weak references. It neither keeps data of pruned or
+  discarded states alive nor counts as an owner in the copy-on-write
+  decisions of SharedLeafData and PriceVector, so shared data is only copied
+  if another decoupled state refers to it. Entries of freed data are removed
+  when they are encountered during lookups and by a sweep whenever the table
+  has doubled in size since the last sweep.
+
+  An owner may modify data it holds exclusively; the entry of that data is
+  then filed under a stale hash and only costs missed hits until the data is
+  freed.
+
+  The tables are static, so lookups are guarded by a mutex for decoupled
+  states that are created on several threads.
+*/
+template<class T, class Hash = utils::Hash<T>, class Equal = std::equal_to<T>>
+class HashConsTable {
+    std::unordered_multimap<std::size_t, std::weak_ptr<T>> table;
+    mutable std::mutex mutex;
+
+    size_t num_lookups;
+    size_t num_hits;
+    // the table is swept once it has twice this size
+    size_t sweep_size;
+
+    void remove_expired() {
+        for (auto it = table.begin(); it != table.end();){
+            if (it->second.expired()){
+                it = table.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        sweep_size = std::max<size_t>(table.size(), 1024);
+    }
+
+public:
+    HashConsTable() : num_lookups(0), num_hits(0), sweep_size(1024) {}
+
+    // returns the canonical object with the same content as data
+    std::shared_ptr<T> intern(const std::shared_ptr<T> &data) {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++num_lookups;
+        std::size_t hash = Hash()(*data);
+        auto range = table.equal_range(hash);
+        for (auto it = range.first; it != range.second;){
+            std::shared_ptr<T> entry = it->second.lock();
+            if (!entry){
+                it = table.erase(it);
+            } else if (entry == data || Equal()(*entry, *data)){
+                ++num_hits;
+                return entry;
+            } else {
+                ++it;
+            }
+        }
+        table.emplace(hash, data);
+        if (table.size() >= 2 * sweep_size){
+            remove_expired();
+        }
+        return data;
+    }
+
+    // the number of interned objects that are still alive
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        size_t num_alive = 0;
+        for (const auto &entry : table){
+            if (!entry.second.expired()){
+                ++num_alive;
+            }
+        }
+        return num_alive;
+    }
+
+    void print_statistics(const std::string &name) const {
+        std::cout << "Interned " << name << ": " << size() << std::endl;
+        std::cout << "Interning lookups for " << name << ": " << num_lookups
+                  << " (" << num_hits << " hits)" << std::endl;
+    }
+};
+
+
+/*
+  Per-factor data of a decoupled state that is shared copy-on-write between
+  decoupled states. With intern(), equal data of different decoupled states
+  is shared as well, so that equality can be tested by comparing pointers.
+*/
+template<class T>
+class SharedLeafData {
+    std::shared_ptr<T> data;
+
+    static HashConsTable<T> table;
+
+    static const std::shared_ptr<T> &get_empty() {
+        static const std::shared_ptr<T> empty = std::make_shared<T>();
+        return empty;
+    }
+
+public:
+    SharedLeafData() : data(get_empty()) {}
+
+    explicit SharedLeafData(T &&value) : data(std::make_shared<T>(std::move(value))) {}
+
+    const T &operator*() const {
+        return *data;
+    }
+
+    const T *operator->() const {
+        return data.get();
+    }
+
+    // copies the data first if it is shared with another object, the
+    // hash-consing table does not count as an owner
+    T &get_writable() {
+        if (data.use_count() > 1){
+            data = std::make_shared<T>(*data);
+        }
+        assert(data.use_count() == 1);
+        return *data;
+    }
+
+    void intern() {
+        data = table.intern(data);
+    }
+
+    bool shares_data_with(const SharedLeafData &other) const {
+        return data == other.data;
+    }
+
+    // the number of decoupled states referring to this data
+    long get_num_references() const {
+        return data.use_count();
+    }
+
+    static void print_statistics(const std::string &name) {
+        table.print_statistics(name);
+    }
+};
+
+template<class T>
+HashConsTable<T> SharedLeafData<T>::table;
+
+template<class T>
+void feed(utils::HashState &hash_state, const SharedLeafData<T> &data) {
+    feed(hash_state, *data);
+}
+
+#endif
@@ -0,0 +1,300 @@
+#include "concurrent_predefinitions.h"
+
+#include "options/predefinitions.h"
+#include "options/registries.h"
+#include "task_utils/causal_graph.h"
+#include "utils/rng_options.h"
+#include "utils/strings.h"
+#include "utils/system.h"
+#include "utils/thread_pool.h"
+#include "utils/timer.h"
+
+#include <algorithm>
+#include <cctype>
+#include <exception>
+#include <iostream>
+#include <limits>
+#include <mutex>
+#include <streambuf>
+#include <unordered_set>
+
+using namespace std;
+
+/*
+  Plugins whose construction only reads shared state. Their constructions
+  do not register states in g_state_registry (which also uses the scratch
+  buffers of g_axiom_evaluator), do not create compliant path graphs (which
+  initialize the static leaf state spaces of ExplicitStateCPG) and do not
+  change the format flags of cout. Interning price vectors is guarded by a
+  mutex. The subcomponents of these plugins (pattern generators, merge
+  strategies, ...) only use the task proxy and the causal graph, which is
+  computed before the constructions start.
+*/
+static const unordered_set<string> CONCURRENT_PLUGINS = {
+    "gamer_pdbs", "max_scp_single_leaf", "merge_and_shrink", "perimeter"};
+
+/*
+  Plugins that use a CUDD manager. Each heuristic has its own manager, but
+  CUDD swaps the global out-of-memory handler while it initializes a
+  manager and resizes its caches, so at most one of them is constructed
+  at a time.
+*/
+static const unordered_set<string> CUDD_PLUGINS = {"gamer_pdbs", "perimeter"};
+
+static thread_local const string *thread_prefix = nullptr;
+static thread_local string thread_line;
+
+/*
+  Replaces the stream buffer of a stream while alive. Output of threads
+  without a prefix is passed through, output of threads with a prefix is
+  collected and written as complete lines, so that the lines of concurrent
+  constructions do not interleave.
+*/
+class PrefixedLineBuffer : public streambuf {
+    ostream &stream;
+    streambuf *original;
+    mutex output_mutex;
+
+    void write_line() {
+        lock_guard<mutex> lock(output_mutex);
+        original->sputn(thread_prefix->data(), thread_prefix->size());
+        original->sputn(thread_line.data(), thread_line.size());
+        original->pubsync();
+        thread_line.clear();
+    }
+
+    void append(char c) {
+        thread_line.push_back(c);
+        if (c == '\n') {
+            write_line();
+        }
+    }
+protected:
+    virtual int_type overflow(int_type c) override {
+        if (traits_type::eq_int_type(c, traits_type::eof())) {
+            return traits_type::not_eof(c);
+        }
+        if (thread_prefix) {
+            append(traits_type::to_char_type(c));
+            return c;
+        }
+        lock_guard<mutex> lock(output_mutex);
+        return original->sputc(traits_type::to_char_type(c));
+    }
+
+    virtual streamsize xsputn(const char *s, streamsize n) override {
+        if (thread_prefix) {
+            for (streamsize i = 0; i < n; ++i) {
+                append(s[i]);
+            }
+            return n;
+        }
+        lock_guard<mutex> lock(output_mutex);
+        return original->sputn(s, n);
+    }
+
+    virtual int sync() override {
+        if (thread_prefix) {
+            // incomplete lines are written once they are complete
+            return 0;
+        }
+        lock_guard<mutex> lock(output_mutex);
+        return original->pubsync();
+    }
+public:
+    explicit PrefixedLineBuffer(ostream &stream)
+        : stream(stream),
+          original(stream.rdbuf()) {
+        stream.flush();
+        stream.rdbuf(this);
+    }
+
+    ~PrefixedLineBuffer() {
+        stream.rdbuf(original);
+    }
+
+    // Prefix the output of the calling thread while prefix is set.
+    void set_prefix(const string *prefix) {
+        if (thread_prefix && !thread_line.empty()) {
+            append('\n');
+        }
+        thread_prefix = prefix;
+    }
+};
+
+
+ConcurrentPredefinitions::ConcurrentPredefinitions(
+    options::Registry &registry, options::Predefinitions &predefinitions,
+    int num_threads)
+    : registry(registry),
+      predefinitions(predefinitions),
+      num_threads(num_threads) {
+}
+
+static string get_plugin_name(const string &definition) {
+    string name = definition.substr(0, definition.find('('));
+    utils::strip(name);
+    return name;
+}
+
+bool ConcurrentPredefinitions::pending_uses_cudd() const {
+    return any_of(pending.begin(), pending.end(),
+                  [](const PendingPredefinition &predefinition) {
+                      return CUDD_PLUGINS.count(predefinition.plugin) > 0;
+                  });
+}
+
+bool ConcurrentPredefinitions::refers_to_pending(const string &arg) const {
+    unordered_set<string> pending_keys;
+    for (const PendingPredefinition &predefinition : pending) {
+        pending_keys.insert(predefinition.key);
+    }
+    string word;
+    for (char c : arg) {
+        if (isalnum(static_cast<unsigned char>(c)) || c == '_') {
+            word.push_back(c);
+        } else {
+            if (pending_keys.count(word)) {
+                return true;
+            }
+            word.clear();
+        }
+    }
+    return pending_keys.count(word) > 0;
+}
+
+void ConcurrentPredefinitions::add(const string &type, const string &arg) {
+    pair<string, string> predefinition;
+    try {
+        predefinition = utils::split(arg, "=");
+    } catch (utils::StringOperationError &) {
+        // let the registry report the malformed predefinition
+        construct_pending();
+        registry.handle_predefinition(type, arg, predefinitions, false);
+        return;
+    }
+    string key = predefinition.first;
+    utils::strip(key);
+    string plugin = get_plugin_name(predefinition.second);
+    if (!CONCURRENT_PLUGINS.count(plugin)) {
+        construct_pending();
+        cout << "Constructing " << key << " sequentially, " << plugin
+             << " is not safe for concurrent construction" << endl;
+        registry.handle_predefinition(type, arg, predefinitions, false);
+        return;
+    }
+    if (refers_to_pending(predefinition.second) ||
+        (CUDD_PLUGINS.count(plugin) && pending_uses_cudd())) {
+        construct_pending();
+    }
+    pending.push_back({type, key, arg, plugin});
+}
+
+void ConcurrentPredefinitions::construct_pending() {
+    if (pending.size() <= 1 || num_threads <= 1) {
+        for (const PendingPredefinition &predefinition : pending) {
+            registry.handle_predefinition(
+                predefinition.type, predefinition.arg, predefinitions, false);
+        }
+        pending.clear();
+        return;
+    }
+
+    /*
+      Compute lazily initialized global task information up front. The
+      initial state is not computed here: in decoupled search, its CPG
+      depends on options of the search engine, which is not set up yet.
+    */
+    causal_graph::get_causal_graph();
+
+    size_t num_tasks = pending.size();
+    vector<options::Predefinitions> results(num_tasks, predefinitions);
+    vector<string> prefixes(num_tasks);
+    vector<double> construction_times(num_tasks, 0);
+    vector<double> construction_cpu_times(num_tasks, 0);
+    vector<exception_ptr> errors(num_tasks);
+    for (size_t id = 0; id < num_tasks; ++id) {
+        prefixes[id] = "[" + pending[id].key + "] ";
+    }
+
+    int used_threads = min(num_threads, static_cast<int>(num_tasks));
+    cout << "Constructing " << num_tasks << " predefinitions concurrently on "
+         << used_threads << " threads" << endl;
+    double cpu_time_limit = utils::get_cpu_time_limit();
+    if (cpu_time_limit != numeric_limits<double>::infinity()) {
+        cout << "Remaining CPU time limit: "
+             << max(0.0, cpu_time_limit - utils::g_timer()) << "s, consumed "
+             << "up to " << used_threads << " times faster than the "
+             << "wall-clock time budgets of the constructions" << endl;
+    }
+    // created before the wall-clock scope, so it measures process CPU time
+    utils::Timer cpu_timer;
+    utils::WallClockTimerScope wall_clock_timers;
+    utils::Timer timer;
+    {
+        PrefixedLineBuffer output(cout);
+        utils::ThreadPool thread_pool(used_threads);
+        thread_pool.run(num_tasks, [&](size_t id) {
+                            utils::WallClockTimerScope task_wall_clock_timers;
+                            utils::ThreadLocalGlobalRNGScope task_rng;
+                            output.set_prefix(&prefixes[id]);
+                            utils::Timer construction_timer;
+                            double start_cpu_time = utils::get_thread_cpu_time();
+                            try {
+                                registry.handle_predefinition(
+                                    pending[id].type, pending[id].arg,
+                                    results[id], false);
+                            } catch (...) {
+                                errors[id] = current_exception();
+                            }
+                            construction_times[id] = construction_timer();
+                            construction_cpu_times[id] =
+                                utils::get_thread_cpu_time() - start_cpu_time;
+                            output.set_prefix(nullptr);
+                        });
+    }
+    double wall_time = timer();
+
+    for (size_t id = 0; id < num_tasks; ++id) {
+        if (errors[id]) {
+            rethrow_exception(errors[id]);
+        }
+    }
+    double summed_time = 0;
+    double summed_cpu_time = 0;
+    for (size_t id = 0; id < num_tasks; ++id) {
+        predefinitions.predefine_from(pending[id].key, results[id]);
+        summed_time += construction_times[id];
+        summed_cpu_time += construction_cpu_times[id];
+        cout << "Construction time for " << pending[id].key << ": "
+             << construction_times[id] << "s, CPU time of its thread: "
+             << construction_cpu_times[id] << "s" << endl;
+    }
+    double cpu_time = cpu_timer();
+    cout << "Concurrent construction time: " << wall_time << "s" << endl;
+    cout << "Summed construction time: " << summed_time << "s" << endl;
+    cout << "Summed construction thread CPU time: " << summed_cpu_time << "s" << endl;
+    cout << "Concurrent construction CPU time: " << cpu_time << "s" << endl;
+    /*
+      The wall-clock time of a construction includes the time its thread
+      waits for a core, so it overestimates the sequential time if there
+      are fewer cores than threads. The thread CPU time does not.
+    */
+    if (wall_time > 0) {
+        cout << "Construction speedup: " << summed_cpu_time / wall_time << endl;
+    }
+    /*
+      A construction running on a single thread uses at most its wall-clock
+      time in CPU time, so the batch uses at most the summed budgets, like a
+      sequential run. Constructions that start threads themselves use more
+      CPU time than their budgets suggest.
+    */
+    if (cpu_time > 1.1 * summed_time + 1) {
+        cout << "WARNING: the constructions used more CPU time than their "
+             << "summed construction times, e.g. because they use several "
+             << "threads themselves. Their time budgets do not bound the CPU "
+             << "time that counts towards the time limit of the planner."
+             << endl;
+    }
+    pending.clear();
+}
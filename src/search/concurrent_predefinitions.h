@@ -0,0 +1,60 @@
+#ifndef CONCURRENT_PREDEFINITIONS_H
+#define CONCURRENT_PREDEFINITIONS_H
+
+#include <string>
+#include <vector>
+
+namespace options {
+class Predefinitions;
+class Registry;
+}
+
+/*
+  Constructs predefinitions from the command line (e.g. --heuristic h=...)
+  on several threads. Predefinitions are queued with add() and constructed
+  concurrently by construct_pending(). A predefinition that refers to a
+  queued one starts a new batch, so it only sees completed objects.
+
+  Only plugins audited for concurrent construction are queued, all others
+  are constructed sequentially (see CONCURRENT_PLUGINS). Plugins using CUDD
+  are not constructed concurrently with each other.
+
+  During construction the global task is only read: the lazily computed
+  causal graph is computed beforehand, timers measure wall-clock time, every
+  construction gets its own default RNG and output lines are prefixed with the
+  predefined name.
+
+  The CPU time limit set by the driver counts the CPU time of all threads, so
+  a batch consumes it up to num_threads times faster than the wall-clock
+  budgets elapse. As long as every construction runs on a single thread, the
+  batch uses at most the summed budgets in CPU time, i.e. no more than a
+  sequential run. The CPU time of each batch is logged, with a warning if it
+  exceeds the summed construction times.
+*/
+class ConcurrentPredefinitions {
+    struct PendingPredefinition {
+        // name of the command line argument without "--", e.g. "heuristic"
+        std::string type;
+        std::string key;
+        std::string arg;
+        // name of the constructed plugin, e.g. "gamer_pdbs"
+        std::string plugin;
+    };
+
+    options::Registry &registry;
+    options::Predefinitions &predefinitions;
+    int num_threads;
+    std::vector<PendingPredefinition> pending;
+
+    bool pending_uses_cudd() const;
+    bool refers_to_pending(const std::string &arg) const;
+public:
+    ConcurrentPredefinitions(options::Registry &registry,
+                             options::Predefinitions &predefinitions,
+                             int num_threads);
+
+    void add(const std::string &type, const std::string &arg);
+    void construct_pending();
+};
+
+#endif
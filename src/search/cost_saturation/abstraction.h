@@ -83,6 +83,7 @@ public:
 
     int get_abstract_state_id(const GlobalState &concrete_state) const;
     int get_abstract_state_id(const State &concrete_state) const;
+    int get_abstract_state_id(const std::vector<int> &concrete_state) const;
     std::unique_ptr<AbstractionFunction> extract_abstraction_function();
 
     virtual void dump() const = 0;
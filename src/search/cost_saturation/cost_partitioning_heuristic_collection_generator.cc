@@ -4,6 +4,7 @@
 #include "diversifier.h"
 #include "order_generator.h"
 #include "order_optimizer.h"
+#include "state_sampler.h"
 #include "utils.h"
 
 #include "../task_proxy.h"
@@ -14,34 +15,38 @@
 #include "../utils/countdown_timer.h"
 #include "../utils/logging.h"
 #include "../utils/memory.h"
+#include "../utils/rng.h"
+#include "../utils/thread_pool.h"
 
 #include <cassert>
+#include <functional>
+#include <limits>
+#include <mutex>
 
 using namespace std;
 
 namespace cost_saturation {
-static vector<vector<int>> sample_states_and_return_abstract_state_ids(
-    const TaskProxy &task_proxy,
-    const Abstractions &abstractions,
-    sampling::RandomWalkSampler &sampler,
+static vector<Sample> sample_states(
+    const Sample &initial_sample,
+    const function<Sample()> &sample_state,
     int num_samples,
-    int init_h,
-    const DeadEndDetector &is_dead_end,
     double max_sampling_time) {
     assert(num_samples >= 1);
     utils::CountdownTimer sampling_timer(max_sampling_time);
     utils::g_log << "Start sampling" << endl;
-    vector<vector<int>> abstract_state_ids_by_sample;
-    abstract_state_ids_by_sample.push_back(
-        get_abstract_state_ids(abstractions, task_proxy.get_initial_state()));
-    while (static_cast<int>(abstract_state_ids_by_sample.size()) < num_samples
+    vector<Sample> samples;
+    samples.push_back(initial_sample);
+    while (static_cast<int>(samples.size()) < num_samples
            && !sampling_timer.is_expired()) {
-        abstract_state_ids_by_sample.push_back(
-            get_abstract_state_ids(abstractions, sampler.sample_state(init_h, is_dead_end)));
+        samples.push_back(sample_state());
+    }
+    double sampling_time = sampling_timer.get_elapsed_time();
+    utils::g_log << "Samples: " << samples.size() << endl;
+    utils::g_log << "Sampling time: " << sampling_time << endl;
+    if (sampling_time > 0) {
+        utils::g_log << "Samples per second: " << samples.size() / sampling_time << endl;
     }
-    utils::g_log << "Samples: " << abstract_state_ids_by_sample.size() << endl;
-    utils::g_log << "Sampling time: " << sampling_timer.get_elapsed_time() << endl;
-    return abstract_state_ids_by_sample;
+    return samples;
 }
 
 
@@ -53,6 +58,7 @@ CostPartitioningHeuristicCollectionGenerator::CostPartitioningHeuristicCollectio
     bool diversify,
     int num_samples,
     double max_optimization_time,
+    int num_threads,
     const shared_ptr<utils::RandomNumberGenerator> &rng)
     : order_generator(order_generator),
       max_orders(max_orders),
@@ -61,6 +67,7 @@ CostPartitioningHeuristicCollectionGenerator::CostPartitioningHeuristicCollectio
       diversify(diversify),
       num_samples(num_samples),
       max_optimization_time(max_optimization_time),
+      num_threads(num_threads),
       rng(rng) {
 }
 
@@ -69,21 +76,33 @@ CostPartitioningHeuristicCollectionGenerator::generate_cost_partitionings(
     const TaskProxy &task_proxy,
     const Abstractions &abstractions,
     const vector<int> &costs,
-    const CPFunction &cp_function) const {
+    const CPFunction &cp_function,
+    StateSampler *state_sampler) const {
+    // Threads share the time limits, so they refer to wall-clock time.
+    unique_ptr<utils::WallClockTimerScope> wall_clock_timers;
+    if (num_threads > 1) {
+        wall_clock_timers = utils::make_unique_ptr<utils::WallClockTimerScope>();
+    }
     utils::CountdownTimer timer(max_time);
 
     State initial_state = task_proxy.get_initial_state();
 
     order_generator->initialize(abstractions, costs);
 
-    vector<int> abstract_state_ids_for_init = get_abstract_state_ids(
-        abstractions, initial_state);
+    Sample sample_for_init;
+    if (state_sampler) {
+        sample_for_init = state_sampler->get_initial_sample();
+    } else {
+        sample_for_init.abstract_state_ids = get_abstract_state_ids(
+            abstractions, initial_state);
+    }
     Order order_for_init = order_generator->compute_order_for_state(
-        abstract_state_ids_for_init, true);
+        sample_for_init.abstract_state_ids, true);
     vector<int> remaining_costs = costs;
     CostPartitioningHeuristic cp_for_init = cp_function(
-        abstractions, order_for_init, remaining_costs, abstract_state_ids_for_init);
-    int init_h = cp_for_init.compute_heuristic(abstract_state_ids_for_init);
+        abstractions, order_for_init, remaining_costs,
+        sample_for_init.abstract_state_ids);
+    int init_h = sample_for_init.compute_heuristic(cp_for_init);
 
     if (init_h == INF) {
         utils::g_log << "Initial state is unsolvable." << endl;
@@ -98,71 +117,175 @@ CostPartitioningHeuristicCollectionGenerator::generate_cost_partitionings(
             return cp_for_init.compute_heuristic(
                 get_abstract_state_ids(abstractions, state)) == INF;
         };
+    auto sample_state = [&](const sampling::RandomWalkSampler &explicit_sampler,
+                            StateSampler *decoupled_sampler) {
+            if (decoupled_sampler) {
+                return decoupled_sampler->sample_state(init_h, cp_for_init);
+            }
+            Sample sample;
+            sample.abstract_state_ids = get_abstract_state_ids(
+                abstractions, explicit_sampler.sample_state(init_h, is_dead_end));
+            return sample;
+        };
 
     unique_ptr<Diversifier> diversifier;
     if (diversify) {
         double max_sampling_time = timer.get_remaining_time();
         diversifier = utils::make_unique_ptr<Diversifier>(
-            sample_states_and_return_abstract_state_ids(
-                task_proxy, abstractions, sampler, num_samples, init_h, is_dead_end, max_sampling_time));
+            sample_states(
+                sample_for_init, [&]() {return sample_state(sampler, state_sampler);},
+                num_samples, max_sampling_time));
     }
 
     utils::g_log << "Start computing cost partitionings" << endl;
     vector<CostPartitioningHeuristic> cp_heuristics;
     int evaluated_orders = 0;
     int size_kb = 0;
-    while (static_cast<int>(cp_heuristics.size()) < max_orders &&
-           (!timer.is_expired() || cp_heuristics.empty()) &&
-           (size_kb < max_size_kb)) {
-        bool is_first_order = (evaluated_orders == 0);
-
-        vector<int> abstract_state_ids;
-        Order order;
-        CostPartitioningHeuristic cp_heuristic;
-        if (is_first_order) {
-            // Use initial state as first sample.
-            abstract_state_ids = abstract_state_ids_for_init;
-            order = order_for_init;
-            cp_heuristic = cp_for_init;
-        } else {
-            abstract_state_ids = get_abstract_state_ids(
-                abstractions, sampler.sample_state(init_h, is_dead_end));
-            order = order_generator->compute_order_for_state(
-                abstract_state_ids, false);
-            vector<int> remaining_costs = costs;
-            cp_heuristic = cp_function(abstractions, order, remaining_costs, abstract_state_ids);
+    if (num_threads > 1) {
+        /*
+          Each thread samples states and optimizes orders for them with its
+          own sampler. The order generator and the collection, including the
+          diversifier, are shared and only accessed under a lock.
+        */
+        utils::g_log << "Computing orders on " << num_threads << " threads" << endl;
+        vector<shared_ptr<utils::RandomNumberGenerator>> thread_rngs;
+        vector<unique_ptr<StateSampler>> thread_state_samplers;
+        for (int i = 0; i < num_threads; ++i) {
+            thread_rngs.push_back(make_shared<utils::RandomNumberGenerator>(
+                                      rng->random(numeric_limits<int>::max())));
+            if (state_sampler) {
+                thread_state_samplers.push_back(
+                    state_sampler->create_thread_sampler(thread_rngs.back()));
+            }
         }
+        mutex order_generator_mutex;
+        mutex collection_mutex;
+        int started_orders = 0;
+        function<void(size_t)> compute_orders = [&](size_t thread_id) {
+            utils::WallClockTimerScope thread_wall_clock_timers;
+            sampling::RandomWalkSampler thread_sampler(
+                task_proxy, *thread_rngs[thread_id]);
+            StateSampler *thread_state_sampler = state_sampler ?
+                thread_state_samplers[thread_id].get() : nullptr;
+            while (true) {
+                bool is_first_order;
+                {
+                    lock_guard<mutex> lock(collection_mutex);
+                    if (static_cast<int>(cp_heuristics.size()) >= max_orders ||
+                        (timer.is_expired() && !cp_heuristics.empty()) ||
+                        size_kb >= max_size_kb) {
+                        break;
+                    }
+                    is_first_order = (started_orders++ == 0);
+                }
 
-        // Optimize order.
-        double optimization_time = min(
-            static_cast<double>(timer.get_remaining_time()), max_optimization_time);
-        if (optimization_time > 0) {
-            utils::CountdownTimer opt_timer(optimization_time);
-            int incumbent_h_value = cp_heuristic.compute_heuristic(abstract_state_ids);
-            optimize_order_with_hill_climbing(
-                cp_function, opt_timer, abstractions, costs, abstract_state_ids, order,
-                cp_heuristic, incumbent_h_value, is_first_order);
-            if (is_first_order) {
-                utils::g_log << "Time for optimizing order: " << opt_timer.get_elapsed_time()
-                    << endl;
+                Sample sample;
+                Order order;
+                CostPartitioningHeuristic cp_heuristic;
+                if (is_first_order) {
+                    sample = sample_for_init;
+                    order = order_for_init;
+                    cp_heuristic = cp_for_init;
+                } else {
+                    sample = sample_state(thread_sampler, thread_state_sampler);
+                    {
+                        lock_guard<mutex> lock(order_generator_mutex);
+                        order = order_generator->compute_order_for_state(
+                            sample.abstract_state_ids, false);
+                    }
+                    vector<int> remaining_costs = costs;
+                    cp_heuristic = cp_function(
+                        abstractions, order, remaining_costs,
+                        sample.abstract_state_ids);
+                }
+
+                double optimization_time = min(
+                    static_cast<double>(timer.get_remaining_time()),
+                    max_optimization_time);
+                if (optimization_time > 0) {
+                    utils::CountdownTimer opt_timer(optimization_time);
+                    int incumbent_h_value =
+                        sample.compute_heuristic(cp_heuristic);
+                    optimize_order_with_hill_climbing(
+                        cp_function, opt_timer, abstractions, costs,
+                        sample, order, cp_heuristic,
+                        incumbent_h_value, is_first_order);
+                }
+
+                lock_guard<mutex> lock(collection_mutex);
+                if (static_cast<int>(cp_heuristics.size()) < max_orders &&
+                    (!diversifier || diversifier->is_diverse(cp_heuristic))) {
+                    size_kb += cp_heuristic.estimate_size_in_kb();
+                    cp_heuristics.push_back(move(cp_heuristic));
+                    if (diversifier) {
+                        utils::g_log << "Average finite h-value for " << num_samples
+                                     << " samples after " << timer.get_elapsed_time()
+                                     << " of diversification: "
+                                     << diversifier->compute_avg_finite_sample_h_value()
+                                     << endl;
+                    }
+                }
+                ++evaluated_orders;
             }
+        };
+        utils::ThreadPool thread_pool(num_threads);
+        thread_pool.run(num_threads, compute_orders);
+        for (const unique_ptr<StateSampler> &thread_state_sampler : thread_state_samplers) {
+            state_sampler->add_statistics(*thread_state_sampler);
         }
+    } else {
+        while (static_cast<int>(cp_heuristics.size()) < max_orders &&
+               (!timer.is_expired() || cp_heuristics.empty()) &&
+               (size_kb < max_size_kb)) {
+            bool is_first_order = (evaluated_orders == 0);
 
-        // If diversify=true, only add order if it improves upon previously
-        // added orders.
-        if (!diversifier || diversifier->is_diverse(cp_heuristic)) {
-            size_kb += cp_heuristic.estimate_size_in_kb();
-            cp_heuristics.push_back(move(cp_heuristic));
-            if (diversifier) {
-                utils::g_log << "Average finite h-value for " << num_samples
-                    << " samples after " << timer.get_elapsed_time()
-                    << " of diversification: "
-                    << diversifier->compute_avg_finite_sample_h_value()
-                    << endl;
+            Sample sample;
+            Order order;
+            CostPartitioningHeuristic cp_heuristic;
+            if (is_first_order) {
+                // Use initial state as first sample.
+                sample = sample_for_init;
+                order = order_for_init;
+                cp_heuristic = cp_for_init;
+            } else {
+                sample = sample_state(sampler, state_sampler);
+                order = order_generator->compute_order_for_state(
+                    sample.abstract_state_ids, false);
+                vector<int> remaining_costs = costs;
+                cp_heuristic = cp_function(abstractions, order, remaining_costs, sample.abstract_state_ids);
+            }
+
+            // Optimize order.
+            double optimization_time = min(
+                static_cast<double>(timer.get_remaining_time()), max_optimization_time);
+            if (optimization_time > 0) {
+                utils::CountdownTimer opt_timer(optimization_time);
+                int incumbent_h_value = sample.compute_heuristic(cp_heuristic);
+                optimize_order_with_hill_climbing(
+                    cp_function, opt_timer, abstractions, costs, sample, order,
+                    cp_heuristic, incumbent_h_value, is_first_order);
+                if (is_first_order) {
+                    utils::g_log << "Time for optimizing order: " << opt_timer.get_elapsed_time()
+                        << endl;
+                }
+            }
+
+            // If diversify=true, only add order if it improves upon previously
+            // added orders.
+            if (!diversifier || diversifier->is_diverse(cp_heuristic)) {
+                size_kb += cp_heuristic.estimate_size_in_kb();
+                cp_heuristics.push_back(move(cp_heuristic));
+                if (diversifier) {
+                    utils::g_log << "Average finite h-value for " << num_samples
+                        << " samples after " << timer.get_elapsed_time()
+                        << " of diversification: "
+                        << diversifier->compute_avg_finite_sample_h_value()
+                        << endl;
+                }
             }
-        }
 
-        ++evaluated_orders;
+            ++evaluated_orders;
+        }
     }
 
     utils::g_log << "Evaluated orders: " << evaluated_orders << endl;
@@ -170,6 +293,9 @@ CostPartitioningHeuristicCollectionGenerator::generate_cost_partitionings(
     utils::g_log << "Time for computing cost partitionings: " << timer.get_elapsed_time()
         << endl;
     utils::g_log << "Estimated heuristic size: " << size_kb << " KiB" << endl;
+    if (state_sampler) {
+        state_sampler->print_statistics();
+    }
     return cp_heuristics;
 }
 }
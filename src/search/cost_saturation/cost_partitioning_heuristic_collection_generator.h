@@ -15,6 +15,7 @@ class RandomNumberGenerator;
 namespace cost_saturation {
 class CostPartitioningHeuristic;
 class OrderGenerator;
+class StateSampler;
 
 class CostPartitioningHeuristicCollectionGenerator {
     const std::shared_ptr<OrderGenerator> order_generator;
@@ -24,6 +25,7 @@ class CostPartitioningHeuristicCollectionGenerator {
     const bool diversify;
     const int num_samples;
     const double max_optimization_time;
+    const int num_threads;
     const std::shared_ptr<utils::RandomNumberGenerator> rng;
 
 public:
@@ -35,13 +37,20 @@ public:
         bool diversify,
         int num_samples,
         double max_optimization_time,
+        int num_threads,
         const std::shared_ptr<utils::RandomNumberGenerator> &rng);
 
+    /*
+      Compute orders for the initial state and for states sampled with random
+      walks. If state_sampler is given, it provides the samples instead of
+      the explicit-state random walks.
+    */
     CPHeuristics generate_cost_partitionings(
         const TaskProxy &task_proxy,
         const Abstractions &abstractions,
         const std::vector<int> &costs,
-        const CPFunction &cp_function) const;
+        const CPFunction &cp_function,
+        StateSampler *state_sampler = nullptr) const;
 };
 }
 
@@ -1,17 +1,18 @@
 #ifndef COST_SATURATION_DIVERSIFIER_H
 #define COST_SATURATION_DIVERSIFIER_H
 
+#include "state_sampler.h"
 #include "types.h"
 
 namespace cost_saturation {
 class CostPartitioningHeuristic;
 
 class Diversifier {
-    std::vector<std::vector<int>> abstract_state_ids_by_sample;
+    std::vector<Sample> samples;
     std::vector<int> portfolio_h_values;
 
 public:
-    explicit Diversifier(std::vector<std::vector<int>> &&abstract_state_ids_by_sample);
+    explicit Diversifier(std::vector<Sample> &&samples);
 
     /* Return true iff the cost-partitioned heuristic has a higher heuristic
        value than all previously seen heuristics for at least one sample. */
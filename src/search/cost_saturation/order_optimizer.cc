@@ -21,7 +21,7 @@ static bool search_improving_successor(
     const utils::CountdownTimer &timer,
     const Abstractions &abstractions,
     const vector<int> &costs,
-    const vector<int> &abstract_state_ids,
+    const Sample &sample,
     vector<int> &incumbent_order,
     CostPartitioningHeuristic &incumbent_cp,
     int &incumbent_h_value,
@@ -33,9 +33,9 @@ static bool search_improving_successor(
 
             vector<int> remaining_costs = costs;
             CostPartitioningHeuristic neighbor_cp =
-                cp_function(abstractions, incumbent_order, remaining_costs, abstract_state_ids);
+                cp_function(abstractions, incumbent_order, remaining_costs, sample.abstract_state_ids);
 
-            int h = neighbor_cp.compute_heuristic(abstract_state_ids);
+            int h = sample.compute_heuristic(neighbor_cp);
             if (h > incumbent_h_value) {
                 incumbent_cp = move(neighbor_cp);
                 incumbent_h_value = h;
@@ -58,7 +58,7 @@ void optimize_order_with_hill_climbing(
     const utils::CountdownTimer &timer,
     const Abstractions &abstractions,
     const vector<int> &costs,
-    const vector<int> &abstract_state_ids,
+    const Sample &sample,
     vector<int> &incumbent_order,
     CostPartitioningHeuristic &incumbent_cp,
     int incumbent_h_value,
@@ -68,7 +68,7 @@ void optimize_order_with_hill_climbing(
     }
     while (!timer.is_expired()) {
         bool success = search_improving_successor(
-            cp_function, timer, abstractions, costs, abstract_state_ids,
+            cp_function, timer, abstractions, costs, sample,
             incumbent_order, incumbent_cp, incumbent_h_value, verbose);
         if (!success) {
             break;
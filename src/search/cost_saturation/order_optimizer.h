@@ -1,6 +1,7 @@
 #ifndef COST_SATURATION_ORDER_OPTIMIZER_H
 #define COST_SATURATION_ORDER_OPTIMIZER_H
 
+#include "state_sampler.h"
 #include "types.h"
 
 namespace utils {
@@ -9,14 +10,16 @@ class CountdownTimer;
 
 namespace cost_saturation {
 /*
-  Optimize the given order in-place via simple hill climbing.
+  Optimize the given order in-place via simple hill climbing. Neighbors are
+  saturated for the abstract state IDs of the sample and compared by their
+  heuristic value for the sample.
 */
 extern void optimize_order_with_hill_climbing(
     CPFunction cp_function,
     const utils::CountdownTimer &timer,
     const Abstractions &abstractions,
     const std::vector<int> &costs,
-    const std::vector<int> &abstract_state_ids,
+    const Sample &sample,
     Order &incumbent_order,
     CostPartitioningHeuristic &incumbent_cp,
     int incumbent_h_value,
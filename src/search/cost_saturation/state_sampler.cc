@@ -0,0 +1,14 @@
+#include "state_sampler.h"
+
+#include "cost_partitioning_heuristic.h"
+
+using namespace std;
+
+namespace cost_saturation {
+int Sample::compute_heuristic(const CostPartitioningHeuristic &cp_heuristic) const {
+    if (evaluate) {
+        return evaluate(cp_heuristic);
+    }
+    return cp_heuristic.compute_heuristic(abstract_state_ids);
+}
+}
@@ -0,0 +1,68 @@
+#ifndef COST_SATURATION_STATE_SAMPLER_H
+#define COST_SATURATION_STATE_SAMPLER_H
+
+#include "types.h"
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace utils {
+class RandomNumberGenerator;
+}
+
+namespace cost_saturation {
+class CostPartitioningHeuristic;
+
+using SampleEvaluator = std::function<int (const CostPartitioningHeuristic &)>;
+
+/*
+  A sampled state for which orders are computed, optimized and diversified.
+  Order generators and saturators use the abstract state IDs of a concrete
+  representative of the sample. Samples that are not concrete states (e.g.
+  decoupled states) additionally provide a function that computes the
+  heuristic value of a cost partitioning for the sample.
+*/
+struct Sample {
+    std::vector<int> abstract_state_ids;
+    SampleEvaluator evaluate;
+
+    int compute_heuristic(const CostPartitioningHeuristic &cp_heuristic) const;
+};
+
+/*
+  Sample states for which the orders are computed instead of sampling
+  concrete states with random walks. Implementations are only used by one
+  thread at a time, every further thread samples with its own sampler
+  created by create_thread_sampler.
+*/
+class StateSampler {
+public:
+    virtual ~StateSampler() = default;
+
+    virtual Sample get_initial_sample() = 0;
+
+    /*
+      Sample a state with a random walk. The walk length depends on init_h as
+      in sampling::RandomWalkSampler; samples for which cp_for_init detects a
+      dead end are not returned.
+    */
+    virtual Sample sample_state(
+        int init_h, const CostPartitioningHeuristic &cp_for_init) = 0;
+
+    /*
+      Create a sampler with the same initial sample for another thread that
+      draws its random walks from rng. Its samples are valid as long as the
+      created sampler is alive.
+    */
+    virtual std::unique_ptr<StateSampler> create_thread_sampler(
+        const std::shared_ptr<utils::RandomNumberGenerator> &rng) const = 0;
+
+    // Add the statistics of a sampler created by create_thread_sampler.
+    virtual void add_statistics(const StateSampler &thread_sampler) = 0;
+
+    virtual void print_statistics() const = 0;
+};
+}
+
+#endif
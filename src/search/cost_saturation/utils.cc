@@ -144,6 +144,14 @@ void add_order_options_to_parser(OptionParser &parser) {
         "maximum time in seconds for optimizing each order with hill climbing",
         "2",
         Bounds("0", "infinity"));
+    parser.add_option<int>(
+        "threads",
+        "number of threads that sample states and optimize orders "
+        "concurrently; each thread uses its own random number generator "
+        "seeded from the main one. With more than one thread, max_time and "
+        "max_optimization_time are measured in wall-clock time.",
+        "1",
+        Bounds("1", "infinity"));
     utils::add_rng_options(parser);
 }
 
@@ -157,6 +165,7 @@ get_cp_heuristic_collection_generator_from_options(const options::Options &opts)
         opts.get<bool>("diversify"),
         opts.get<int>("samples"),
         opts.get<double>("max_optimization_time"),
+        opts.get<int>("threads"),
         utils::parse_rng_from_options(opts));
 }
 
@@ -6,6 +6,7 @@
 #include "globals.h"
 #include "heuristic.h"
 #include "open_lists/alternation_open_list.h"
+#include "open_lists/bucket_tiebreaking_open_list.h"
 #include "open_lists/open_list_plugins.h"
 #include "open_lists/standard_scalar_open_list.h"
 #include "open_lists/tiebreaking_open_list.h"
@@ -113,6 +114,12 @@ void EagerSearch::initialize() {
     }
 }
 
+void EagerSearch::heuristic_statistics() const {
+    for (Heuristic *h : heuristics) {
+        h->print_statistics();
+    }
+}
+
 void EagerSearch::statistics() const {
     search_progress.print_statistics();
     search_space.statistics();
@@ -207,8 +214,14 @@ SearchStatus EagerSearch::step() {
         if (succ_node.is_new()) {
             // We have not seen this state before.
             // Evaluate and create a new node.
-            for (size_t j = 0; j < heuristics.size(); ++j)
+            for (size_t j = 0; j < heuristics.size(); ++j) {
+                if (g_factoring && found_solution()) {
+                    // see insert_state(), estimates reaching this are pruned
+                    heuristics[j]->set_pruning_threshold(
+                        bound - (node.get_g() + get_adjusted_cost(op) + g_inc_g_by));
+                }
                 heuristics[j]->evaluate(succ_state);
+            }
             succ_node.clear_h_dirty();
             search_progress.inc_evaluated_states();
             search_progress.inc_evaluations(heuristics.size());
@@ -528,6 +541,14 @@ static shared_ptr<SearchEngine> _parse_astar(OptionParser &parser) {
     parser.add_option<bool>("check_consistency",
                             "check for every transition if the heuristic is consistent",
                             "false");
+    parser.add_option<bool>("bucket_open_list",
+            "store the open list in buckets indexed by [f][h] instead of a "
+            "map; requires non-negative integer h values",
+            "false");
+    parser.add_option<bool>("lifo",
+            "with bucket_open_list, expand nodes with equal f and h in LIFO "
+            "instead of FIFO order",
+            "false");
     parser.add_option<shared_ptr<PruningMethod>>("pruning",
             "pruning method",
             OptionParser::NONE);
@@ -545,7 +566,13 @@ static shared_ptr<SearchEngine> _parse_astar(OptionParser &parser) {
         std::vector<shared_ptr<Evaluator>> evals;
         evals.push_back(f_eval);
         evals.push_back(eval);
-        shared_ptr<OpenList<StateID>> open = make_shared<TieBreakingOpenList<StateID>>(evals, false, false);
+        shared_ptr<OpenList<StateID>> open;
+        if (opts.get<bool>("bucket_open_list")) {
+            open = make_shared<BucketTieBreakingOpenList<StateID>>(
+                evals, false, opts.get<bool>("lifo"));
+        } else {
+            open = make_shared<TieBreakingOpenList<StateID>>(evals, false, false);
+        }
 
         opts.set("open", open);
         opts.set("f_eval", f_eval);
@@ -59,6 +59,7 @@ public:
     ~EagerSearch() = default;
     
     void statistics() const;
+    virtual void heuristic_statistics() const override;
 
     void dump_search_space();
 };
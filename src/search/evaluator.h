@@ -59,6 +59,17 @@ public:
         std::cerr << "ERROR: This code must not be called (evaluator.h)!" << std::endl;
         utils::exit_with(utils::ExitCode::SEARCH_CRITICAL_ERROR);
     }
+
+    /*
+      True if evaluate(state) may run concurrently with the evaluation of
+      other evaluators (see the threads option of the max heuristic). It
+      must then only write to data owned by this evaluator: not to the
+      state registry or global operators (e.g. by setting preferred
+      operators) and not to a CUDD manager shared with other evaluators.
+    */
+    virtual bool supports_concurrent_evaluation() const {
+        return false;
+    }
 };
 
 #endif
@@ -19,6 +19,7 @@
 #include <cstdint>
 #include <cstdio>
 #include <cstdlib>
+#include <fstream>
 #include <iostream>
 #include <limits>
 #include <map>
@@ -803,6 +804,112 @@ inline void check_factoring(const vector<set<int>> &factoring) {
     }
 }
 
+static const string FACTORING_CACHE_MAGIC = "factoring_cache_v1";
+
+void Factoring::set_cache(const string &cache_dir_, const string &configuration_) {
+    cache_dir = cache_dir_;
+    configuration = configuration_;
+}
+
+/*
+  The cache key is a fingerprint of the task (variables, initial state, goal,
+  operators) and of the --decoupling argument, because the factoring depends
+  on both.
+*/
+string Factoring::get_cache_file_name() const {
+    utils::HashState hash_state;
+    feed(hash_state, g_variable_domain);
+    feed(hash_state, g_initial_state_data);
+    feed(hash_state, g_goal);
+    feed(hash_state, static_cast<int>(g_operators.size()));
+    for (const Operator &op : g_operators){
+        feed(hash_state, op.get_cost());
+        feed(hash_state, static_cast<int>(op.get_preconditions().size()));
+        for (const Condition &cond : op.get_preconditions()){
+            feed(hash_state, make_pair(cond.var, cond.val));
+        }
+        feed(hash_state, static_cast<int>(op.get_effects().size()));
+        for (const Effect &eff : op.get_effects()){
+            feed(hash_state, make_pair(eff.var, eff.val));
+            feed(hash_state, static_cast<int>(eff.conditions.size()));
+            for (const Condition &cond : eff.conditions){
+                feed(hash_state, make_pair(cond.var, cond.val));
+            }
+        }
+    }
+    for (char c : configuration){
+        feed(hash_state, static_cast<int>(c));
+    }
+    ostringstream file_name;
+    file_name << cache_dir << "/" << hex << hash_state.get_hash64() << ".factoring";
+    return file_name.str();
+}
+
+bool Factoring::load_cached_factoring(const string &file_name,
+                                      FactoredVars &factoring,
+                                      double &factoring_time) const {
+    ifstream in(file_name);
+    string magic;
+    bool abstain;
+    int num_leaves;
+    if (!(in >> magic >> abstain >> factoring_time >> num_leaves) ||
+        magic != FACTORING_CACHE_MAGIC || num_leaves < 0){
+        return false;
+    }
+    int num_vars = g_variable_domain.size();
+    FactoredVars cached_factoring(num_leaves);
+    for (set<int> &leaf : cached_factoring){
+        int leaf_size;
+        if (!(in >> leaf_size) || leaf_size <= 0){
+            return false;
+        }
+        for (int i = 0; i < leaf_size; ++i){
+            int var;
+            if (!(in >> var) || var < 0 || var >= num_vars){
+                return false;
+            }
+            leaf.insert(var);
+        }
+    }
+    if (abstain != (num_leaves < min_number_leaves)){
+        return false;
+    }
+    factoring.swap(cached_factoring);
+    return true;
+}
+
+void Factoring::store_cached_factoring(const string &file_name,
+                                       const FactoredVars &factoring,
+                                       double factoring_time) const {
+    // write to a temporary file first, so that concurrent runs never read a partial entry
+    string tmp_file_name = file_name + ".tmp" + to_string(utils::get_process_id());
+    {
+        ofstream out(tmp_file_name);
+        out << FACTORING_CACHE_MAGIC << endl
+            << (static_cast<int>(factoring.size()) < min_number_leaves) << endl
+            << factoring_time << endl
+            << factoring.size() << endl;
+        for (const set<int> &leaf : factoring){
+            out << leaf.size();
+            for (int var : leaf){
+                out << " " << var;
+            }
+            out << endl;
+        }
+        if (!out){
+            cout << "Warning: could not write factoring cache file " << tmp_file_name << endl;
+            remove(tmp_file_name.c_str());
+            return;
+        }
+    }
+    if (rename(tmp_file_name.c_str(), file_name.c_str()) != 0){
+        cout << "Warning: could not write factoring cache file " << file_name << endl;
+        remove(tmp_file_name.c_str());
+        return;
+    }
+    cout << "Stored factoring in cache: " << file_name << endl;
+}
+
 void Factoring::do_factoring_or_abstain() {
     if (abstain_type == ABSTAIN_TYPE::STANDARD_ON_FAILURE &&
             (has_axioms() || has_conditional_effects())){
@@ -818,7 +925,23 @@ void Factoring::do_factoring_or_abstain() {
     }
 
     FactoredVars best_factoring;
-    if (is_factoring_possible() && (min_number_leaves < 2 || is_two_leaf_factoring_possible())){
+    string cache_file_name;
+    bool cache_hit = false;
+    if (!cache_dir.empty()){
+        cache_file_name = get_cache_file_name();
+        double cached_factoring_time;
+        cache_hit = load_cached_factoring(cache_file_name, best_factoring, cached_factoring_time);
+        if (cache_hit){
+            cout << "Factoring cache hit: " << cache_file_name << endl;
+            cout << "Factoring time saved by cache: "
+                 << max(0.0, cached_factoring_time - factoring_timer.get_elapsed_time()) << "s" << endl;
+        } else {
+            cout << "Factoring cache miss: " << cache_file_name << endl;
+        }
+    }
+
+    if (!cache_hit && is_factoring_possible() &&
+        (min_number_leaves < 2 || is_two_leaf_factoring_possible())){
         // simple sanity check to filter out tasks where no mobile factoring exists
         best_factoring = get_factoring();
         check_factoring(best_factoring);
@@ -832,6 +955,10 @@ void Factoring::do_factoring_or_abstain() {
 
     cout << "factoring time " << factoring_timer.get_elapsed_time() << endl;
 
+    if (!cache_dir.empty() && !cache_hit){
+        store_cached_factoring(cache_file_name, best_factoring, factoring_timer.get_elapsed_time());
+    }
+
     if (static_cast<int>(best_factoring.size()) < min_number_leaves){
         cout << "No factoring with at least " << min_number_leaves << " leaves found!" << endl;
         switch (abstain_type){
@@ -108,6 +108,22 @@ class Factoring {
 
     std::vector<bool> ifork_leaf;
 
+    // directory of the persistent factoring cache, empty if disabled
+    std::string cache_dir;
+
+    // --decoupling argument, part of the key of the factoring cache
+    std::string configuration;
+
+    std::string get_cache_file_name() const;
+
+    bool load_cached_factoring(const std::string &file_name,
+                               std::vector<std::set<int>> &factoring,
+                               double &factoring_time) const;
+
+    void store_cached_factoring(const std::string &file_name,
+                                const std::vector<std::set<int>> &factoring,
+                                double factoring_time) const;
+
     void apply_factoring(const std::vector<std::set<int> > &factoring);
 
     void print_factoring_statistics() const;
@@ -182,6 +198,13 @@ public:
     virtual ~Factoring() = default;
     
     void do_factoring_or_abstain();
+
+    /*
+      Store computed factorings in the existing directory cache_dir and load
+      them from there in later runs. Entries are keyed by a fingerprint of the
+      task and of configuration, the --decoupling argument.
+    */
+    void set_cache(const std::string &cache_dir, const std::string &configuration);
     
     FACTORING_PROFILE get_profile() const {
         return profile;
@@ -2,6 +2,7 @@
 
 #include "algorithms/int_packer.h"
 #include "axioms.h"
+#include "binary_input.h"
 #include "compliant_paths/compliant_path_graph.h"
 #include "compliant_paths/cpg_storage.h"
 #include "compliant_paths/explicit_state_cpg.h"
@@ -157,6 +158,20 @@ void read_variables(istream &in) {
     g_num_facts += range;
     }
 }
+
+static void add_mutex_group(const MutexGroup &mg) {
+    g_mutex_groups.push_back(mg);
+
+    const vector<FactPair> &invariant_group = mg.getFacts();
+    for (size_t j = 0; j < invariant_group.size(); ++j) {
+        const FactPair &fact1 = invariant_group[j];
+        for (size_t k = 0; k < invariant_group.size(); ++k) {
+            const FactPair &fact2 = invariant_group[k];
+            set_mutex(fact1, fact2);
+        }
+    }
+}
+
 //Vidal, Alvaro: Changed all the read_mutexes method
 void read_mutexes(istream &in) {
   g_inconsistent_facts.resize(g_num_facts*g_num_facts, false);
@@ -171,17 +186,7 @@ void read_mutexes(istream &in) {
        aware of. */
 
     for (int i = 0; i < num_mutex_groups; ++i) {
-      MutexGroup mg = MutexGroup(in);
-      g_mutex_groups.push_back(mg);
-
-      const vector<FactPair> & invariant_group = mg.getFacts();
-        for (size_t j = 0; j < invariant_group.size(); ++j) {
-            const FactPair &fact1 = invariant_group[j];
-            for (size_t k = 0; k < invariant_group.size(); ++k) {
-                const FactPair &fact2 = invariant_group[k];
-                set_mutex(fact1, fact2);
-            }
-        }
+      add_mutex_group(MutexGroup(in));
     }
 }
 
@@ -225,8 +230,7 @@ void read_axioms(istream &in) {
     g_axiom_evaluator = new AxiomEvaluator;
 }
 
-void read_everything(istream &in) {
-    cout << "reading input... [t=" << utils::g_timer << "]" << endl;
+static void read_text_task(istream &in) {
     read_and_verify_version(in);
     read_metric(in);
     read_variables(in);
@@ -242,8 +246,98 @@ void read_everything(istream &in) {
     read_goal(in);
     read_operators(in);
     read_axioms(in);
+}
+
+/*
+  Reads the binary format written by preprocess-h2 with --binary_output.
+  The sections are the same as in the text format, without the magic words.
+*/
+static void read_binary_task(BinaryInput &in) {
+    in.read_and_verify_magic();
+    int version = in.read_int();
+    if (version != PRE_FILE_VERSION) {
+        cerr << "Expected preprocessor file version " << PRE_FILE_VERSION
+             << ", got " << version << "." << endl;
+        cerr << "Exiting." << endl;
+        exit_with(utils::ExitCode::SEARCH_INPUT_ERROR);
+    }
+    g_use_metric = in.read_int();
+
+    g_num_facts = 0;
+    int num_variables = in.read_int();
+    g_variable_name.reserve(num_variables);
+    g_axiom_layers.reserve(num_variables);
+    g_variable_domain.reserve(num_variables);
+    g_fact_names.reserve(num_variables);
+    for (int var = 0; var < num_variables; ++var) {
+        g_variable_name.push_back(in.read_string());
+        g_axiom_layers.push_back(in.read_int());
+        int range = in.read_int();
+        g_variable_domain.push_back(range);
+        vector<string> fact_names;
+        fact_names.reserve(range);
+        for (int value = 0; value < range; ++value)
+            fact_names.push_back(in.read_string());
+        g_fact_names.push_back(move(fact_names));
+        g_id_first_fact.push_back(g_num_facts);
+        g_num_facts += range;
+    }
+
+    g_inconsistent_facts.resize(g_num_facts * g_num_facts, false);
+    int num_mutex_groups = in.read_int();
+    for (int i = 0; i < num_mutex_groups; ++i) {
+        add_mutex_group(MutexGroup(in));
+    }
+
+    g_initial_state_data.resize(num_variables);
+    for (int var = 0; var < num_variables; ++var) {
+        g_initial_state_data[var] = in.read_int();
+    }
+    g_default_axiom_values = g_initial_state_data;
+
+    int num_goals = in.read_int();
+    if (num_goals < 1) {
+        cerr << "Task has no goal condition!" << endl;
+        exit_with(utils::ExitCode::SEARCH_INPUT_ERROR);
+    }
+    for (int i = 0; i < num_goals; ++i) {
+        int var = in.read_int();
+        int val = in.read_int();
+        g_goal.push_back(make_pair(var, val));
+    }
+    g_all_goals = g_goal;
+
+    int num_operators = in.read_int();
+    g_operators.reserve(num_operators);
+    for (int i = 0; i < num_operators; ++i)
+        g_operators.push_back(Operator(in, false));
+
+    int num_axioms = in.read_int();
+    g_axioms.reserve(num_axioms);
+    for (int i = 0; i < num_axioms; ++i)
+        g_axioms.push_back(Operator(in, true));
+    g_axiom_evaluator = new AxiomEvaluator;
+
+    if (!in.at_end()) {
+        cerr << "Unexpected data after the end of the binary input." << endl;
+        exit_with(utils::ExitCode::SEARCH_INPUT_ERROR);
+    }
+}
+
+void read_everything(istream &in) {
+    cout << "reading input... [t=" << utils::g_timer << "]" << endl;
+    utils::Timer input_timer;
+    if (BinaryInput::is_binary(in)) {
+        // The file behind std::cin can be mapped into memory directly.
+        BinaryInput binary_input(in, &in == &cin ? 0 : -1);
+        read_binary_task(binary_input);
+    } else {
+        read_text_task(in);
+    }
+    input_timer.stop();
 
     cout << "done reading input! [t=" << utils::g_timer << "]" << endl;
+    cout << "time for reading input: " << input_timer << endl;
 
     // TODO: this has to happen *before* factoring does anything in order to
     // keep a copy of g_goal.
@@ -273,35 +367,12 @@ void read_everything(istream &in) {
             }
         }
 
-        // TODO further adapt this based on experiments
-        // TODO it can probably be somewhat aligned with the bin-packing, too.
-        // if we need a new bucket anyway, then we could as well use an entire int
-        if (CompliantPathGraph::get_pruning_options().use_exact_duplicate_checking()){
-            // numbers are slightly higher than so-far observed maximum
-            switch (g_factoring->get_search_type()){
-            case ASDA:
-            case SDA: MAX_DUPLICATE_COUNTER = 1500000; break;
-            case SAT: MAX_DUPLICATE_COUNTER = 400000; break;
-            case UNSAT: MAX_DUPLICATE_COUNTER = 2000000; break;
-
-            default: cerr << "Unknown decoupled search type." << endl;
-                     exit_with(utils::ExitCode::SEARCH_CRITICAL_ERROR);
-            }
-        } else {
-            // numbers are roughly double than so-far observed maximum
-            switch (g_factoring->get_search_type()){
-            case ASDA:
-            case SDA: MAX_DUPLICATE_COUNTER = 50000; break;
-            case SAT: MAX_DUPLICATE_COUNTER = 100000; break;
-            case UNSAT: MAX_DUPLICATE_COUNTER = 50000; break;
-
-            default: cerr << "Unknown decoupled search type." << endl;
-                     exit_with(utils::ExitCode::SEARCH_CRITICAL_ERROR);
-            }
+        if (center_domains.empty()){
+            // the decoupled states are distinguished by the StateRegistry,
+            // but the packed center needs at least one bin
+            center_domains.push_back(2);
         }
 
-        center_domains.push_back(MAX_DUPLICATE_COUNTER);
-
         cout << "packing state variables..." << flush;
         g_state_packer = new int_packer::IntPacker(center_domains);
         cout << "Variables: " << g_center.size() << endl;
@@ -450,8 +521,6 @@ bool g_use_metric;
 int g_min_action_cost = numeric_limits<int>::max();
 int g_max_action_cost = 0;
 
-int MAX_DUPLICATE_COUNTER;
-
 shared_ptr<Factoring> g_factoring;
 
 int g_inc_g_by;
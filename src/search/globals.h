@@ -76,8 +76,6 @@ extern bool g_use_metric;
 extern int g_min_action_cost;
 extern int g_max_action_cost;
 
-extern int MAX_DUPLICATE_COUNTER;
-
 extern std::shared_ptr<Factoring> g_factoring;
 
 // HACK this is used to increase the g-value of a node generated by the search
@@ -69,6 +69,12 @@ public:
     virtual void get_involved_heuristics(std::set<Heuristic*> &hset) override {hset.insert(this); }
     virtual OperatorCost get_cost_type() const override {return cost_type; }
 
+    // Upper bound for the next evaluation: states with an estimate of at
+    // least threshold are pruned by the search, so heuristics combining
+    // several estimates may stop early. Reset after the evaluation.
+    virtual void set_pruning_threshold(int /*threshold*/) {}
+    virtual void print_statistics() const {}
+
     static void add_options_to_parser(options::OptionParser &parser);
     static options::Options default_options();
 };
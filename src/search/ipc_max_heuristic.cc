@@ -1,10 +1,19 @@
 #include "ipc_max_heuristic.h"
 
+#include "globals.h"
 #include "operator_id.h"
 #include "option_parser.h"
 #include "plugin.h"
 
+#include "compliant_paths/cpg_storage.h"
+#include "utils/memory.h"
+#include "utils/thread_pool.h"
+
+#include <algorithm>
+#include <chrono>
 #include <limits>
+#include <numeric>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -12,18 +21,104 @@ using namespace std;
 
 
 IPCMaxHeuristic::IPCMaxHeuristic(const Options &opts)
-    : Heuristic(opts), evaluators(opts.get_list<shared_ptr<Evaluator>>("heuristics")) {
+    : Heuristic(opts),
+      evaluators(opts.get_list<shared_ptr<Evaluator>>("heuristics")),
+      cheapest_first(opts.get<bool>("cheapest_first")),
+      bound_cutoff(opts.get<bool>("bound_cutoff")),
+      reorder_interval(opts.get<int>("reorder_interval")),
+      order(evaluators.size()),
+      statistics(evaluators.size()),
+      num_evaluations(0),
+      num_cutoffs(0),
+      evaluation_time(0),
+      pruning_threshold(numeric_limits<int>::max()) {
+    iota(order.begin(), order.end(), 0);
+    int num_threads = min<int>(opts.get<int>("threads"), evaluators.size());
+    if (num_threads > 1) {
+        verify_concurrent_components();
+        thread_pool = utils::make_unique_ptr<utils::ThreadPool>(num_threads);
+        component_values.resize(evaluators.size());
+        component_dead_ends.resize(evaluators.size());
+        cout << "max heuristic: evaluating components on " << num_threads
+             << " threads" << endl;
+    }
 }
 
 IPCMaxHeuristic::~IPCMaxHeuristic() {
 }
 
+void IPCMaxHeuristic::verify_concurrent_components() const {
+    set<Evaluator *> distinct;
+    for (size_t i = 0; i < evaluators.size(); ++i) {
+        if (!evaluators[i]->supports_concurrent_evaluation()) {
+            cerr << "max heuristic: component " << i << " does not support "
+                 << "concurrent evaluation, use threads=1" << endl;
+            utils::exit_with(utils::ExitCode::SEARCH_INPUT_ERROR);
+        }
+        if (!distinct.insert(evaluators[i].get()).second) {
+            cerr << "max heuristic: the same heuristic cannot be evaluated "
+                 << "on several threads" << endl;
+            utils::exit_with(utils::ExitCode::SEARCH_INPUT_ERROR);
+        }
+    }
+}
+
+void IPCMaxHeuristic::reorder_components() {
+    // stable, so components with equal cost keep the order given by the user
+    stable_sort(order.begin(), order.end(), [this](int a, int b) {
+        return statistics[a].time_per_call() < statistics[b].time_per_call();
+    });
+}
+
+void IPCMaxHeuristic::set_pruning_threshold(int threshold) {
+    if (bound_cutoff) {
+        pruning_threshold = threshold;
+    }
+}
+
+void IPCMaxHeuristic::evaluate_component(int i, const GlobalState &state) {
+    using clock = chrono::steady_clock;
+    ComponentStatistics &stats = statistics[i];
+    clock::time_point start = clock::now();
+    evaluators[i]->evaluate(state);
+    stats.time += chrono::duration<double>(clock::now() - start).count();
+    ++stats.calls;
+}
+
 int IPCMaxHeuristic::compute_heuristic(const GlobalState &state) {
+    using clock = chrono::steady_clock;
+    clock::time_point start = clock::now();
+
+    int result;
+    // The first evaluation runs sequentially, so that the output of the
+    // lazy initialization of the components is not interleaved.
+    if (thread_pool && num_evaluations > 0) {
+        result = compute_parallel(state);
+    } else {
+        result = compute_sequential(state);
+    }
+    ++num_evaluations;
+
+    evaluation_time += chrono::duration<double>(clock::now() - start).count();
+    return result;
+}
+
+int IPCMaxHeuristic::compute_sequential(const GlobalState &state) {
+    // the threshold only applies to the state it was set for
+    int threshold = pruning_threshold;
+    pruning_threshold = numeric_limits<int>::max();
+
+    if (cheapest_first && num_evaluations > 0 &&
+        num_evaluations % reorder_interval == 0) {
+        reorder_components();
+    }
+
     dead_end = false;
     dead_end_reliable = false;
     value = 0;
-    for (size_t i = 0; i < evaluators.size(); ++i) {
-        evaluators[i]->evaluate(state);
+    for (size_t pos = 0; pos < order.size(); ++pos) {
+        int i = order[pos];
+        evaluate_component(i, state);
 
         if (evaluators[i]->is_dead_end()) {
             value = numeric_limits<int>::max();
@@ -31,15 +126,104 @@ int IPCMaxHeuristic::compute_heuristic(const GlobalState &state) {
             if (evaluators[i]->dead_end_is_reliable()) {
                 dead_end_reliable = true;
                 value = -1;
+                for (size_t rest = pos + 1; rest < order.size(); ++rest) {
+                    ++statistics[order[rest]].skipped_dead_end;
+                }
                 break;
             }
         } else {
             value = max(value, evaluators[i]->get_value());
+            if (!dead_end && value >= threshold) {
+                // the state will be pruned by the search, the remaining
+                // components cannot change that
+                for (size_t rest = pos + 1; rest < order.size(); ++rest) {
+                    ++statistics[order[rest]].skipped_cutoff;
+                }
+                if (pos + 1 < order.size()) {
+                    ++num_cutoffs;
+                }
+                break;
+            }
         }
     }
     return value;
 }
 
+int IPCMaxHeuristic::compute_parallel(const GlobalState &state) {
+    // all components are evaluated, so there is nothing to cut off
+    pruning_threshold = numeric_limits<int>::max();
+
+    /*
+      The components only share the CPG of the state. Looking it up once
+      here fills the lookup cache of the CPG storage, so that the lookups
+      of the components only read it.
+    */
+    if (g_factoring && CPGStorage::storage) {
+        CPGStorage::storage->get_cpg(state);
+    }
+
+    function<void(size_t)> task = [&](size_t i) {
+        evaluate_component(i, state);
+        // query the results here, the evaluator is not touched concurrently
+        component_dead_ends[i] = evaluators[i]->is_dead_end();
+        if (component_dead_ends[i]) {
+            component_dead_ends[i] += evaluators[i]->dead_end_is_reliable();
+        } else {
+            component_values[i] = evaluators[i]->get_value();
+        }
+    };
+    thread_pool->run(evaluators.size(), task);
+
+    dead_end = false;
+    dead_end_reliable = false;
+    value = 0;
+    for (size_t i = 0; i < evaluators.size(); ++i) {
+        if (component_dead_ends[i]) {
+            value = numeric_limits<int>::max();
+            dead_end = true;
+            if (component_dead_ends[i] == 2) {
+                dead_end_reliable = true;
+                value = -1;
+                break;
+            }
+        } else {
+            value = max(value, component_values[i]);
+        }
+    }
+    return value;
+}
+
+void IPCMaxHeuristic::print_statistics() const {
+    double component_time = 0;
+    for (const ComponentStatistics &stats : statistics) {
+        component_time += stats.time;
+    }
+    cout << "max heuristic: " << num_evaluations << " evaluations, "
+         << num_cutoffs << " stopped at the pruning threshold" << endl;
+    cout << "max heuristic: " << evaluation_time << "s wall-clock time, "
+         << component_time << "s in components";
+    if (thread_pool && evaluation_time > 0) {
+        cout << ", parallel speedup " << component_time / evaluation_time;
+    }
+    cout << endl;
+    if (num_evaluations > 0) {
+        cout << "max heuristic: " << evaluation_time / num_evaluations * 1e6
+             << "us wall-clock time per evaluation, "
+             << component_time / num_evaluations * 1e6
+             << "us in components per evaluation" << endl;
+    }
+    for (size_t pos = 0; pos < order.size(); ++pos) {
+        int i = order[pos];
+        const ComponentStatistics &stats = statistics[i];
+        cout << "max heuristic component " << i << ": "
+             << stats.calls << " calls, "
+             << stats.time << "s total, "
+             << stats.time_per_call() * 1e6 << "us per call, "
+             << stats.skipped_dead_end << " skipped after dead end, "
+             << stats.skipped_cutoff << " skipped at pruning threshold" << endl;
+    }
+}
+
 bool IPCMaxHeuristic::reach_state(const GlobalState &parent_state, OperatorID op,
                                   const GlobalState &state) {
     bool result = false;
@@ -55,6 +239,34 @@ bool IPCMaxHeuristic::reach_state(const GlobalState &parent_state, OperatorID op
 static shared_ptr<Evaluator> _parse(OptionParser &parser) {
     parser.document_synopsis("IPC-Max Heuristic", "");
     parser.add_list_option<shared_ptr<Evaluator>>("heuristics");
+    parser.add_option<bool>(
+        "cheapest_first",
+        "evaluate the components in increasing order of their measured time "
+        "per call, so that dead ends and the pruning threshold are detected "
+        "by the cheapest components first",
+        "false");
+    parser.add_option<bool>(
+        "bound_cutoff",
+        "stop evaluating components once the value reaches the pruning "
+        "threshold of the search; the (admissible) partial maximum is returned, "
+        "so h-values and expansion counts can differ from evaluating all "
+        "components",
+        "false");
+    parser.add_option<int>(
+        "reorder_interval",
+        "number of evaluations between two reorderings of the components "
+        "if cheapest_first=true",
+        "1000",
+        Bounds("1", "infinity"));
+    parser.add_option<int>(
+        "threads",
+        "number of threads evaluating the components of a state concurrently; "
+        "with more than one thread all components are evaluated, so "
+        "cheapest_first and bound_cutoff have no effect. Supported components "
+        "are max_scp_single_leaf, gamer_pdbs, perimeter and merge_and_shrink (except "
+        "with decoupled_lookup=exact_icaps23); they must not be listed twice.",
+        "1",
+        Bounds("1", "infinity"));
     Heuristic::add_options_to_parser(parser);
     Options opts = parser.parse();
 
@@ -3,18 +3,68 @@
 
 #include "heuristic.h"
 
+#include <cstdint>
+#include <memory>
 #include <vector>
 
 namespace options {
 class Options;
 }
 
+namespace utils {
+class ThreadPool;
+}
+
 class IPCMaxHeuristic : public Heuristic {
+    struct ComponentStatistics {
+        uint64_t calls;
+        uint64_t skipped_dead_end;
+        uint64_t skipped_cutoff;
+        double time;
+
+        ComponentStatistics()
+            : calls(0), skipped_dead_end(0), skipped_cutoff(0), time(0) {
+        }
+        double time_per_call() const {
+            return calls == 0 ? 0 : time / calls;
+        }
+    };
+
     std::vector<std::shared_ptr<Evaluator>> evaluators;
     int value;
     bool dead_end;
     bool dead_end_reliable;
 
+    // evaluate the components cheapest-first (by measured time per call)
+    const bool cheapest_first;
+    // stop evaluating once the value reaches the pruning threshold
+    const bool bound_cutoff;
+    const int reorder_interval;
+
+    // evaluates the components of a state concurrently if set (threads > 1)
+    std::unique_ptr<utils::ThreadPool> thread_pool;
+    std::vector<int> component_values;
+    // 0: no dead end, 1: dead end, 2: reliable dead end
+    std::vector<char> component_dead_ends;
+
+    // evaluation order of the components, indices into evaluators
+    std::vector<int> order;
+    std::vector<ComponentStatistics> statistics;
+    uint64_t num_evaluations;
+    uint64_t num_cutoffs;
+    // wall-clock time of all evaluations
+    double evaluation_time;
+
+    // set by the search before evaluating a state, consumed by the evaluation
+    int pruning_threshold;
+
+    // exits if a component cannot be evaluated concurrently
+    void verify_concurrent_components() const;
+    void reorder_components();
+    void evaluate_component(int i, const GlobalState &state);
+    int compute_sequential(const GlobalState &state);
+    int compute_parallel(const GlobalState &state);
+
 protected:
     virtual int compute_heuristic(const GlobalState &state);
 
@@ -23,6 +73,8 @@ public:
     ~IPCMaxHeuristic();
     virtual bool reach_state(const GlobalState &parent_state, OperatorID op,
                              const GlobalState &state);
+    virtual void set_pruning_threshold(int threshold) override;
+    virtual void print_statistics() const override;
 };
 
 #endif
@@ -0,0 +1,360 @@
+#include "flat_merge_and_shrink_representation.h"
+
+#include "merge_and_shrink_representation.h"
+#include "types.h"
+
+#include "../globals.h"
+#include "../state.h"
+#include "../state_registry.h"
+
+#include "../compliant_paths/cpg_storage.h"
+#include "../compliant_paths/explicit_state_cpg.h"
+
+#include "../utils/hash.h"
+
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <limits>
+
+using namespace std;
+
+namespace merge_and_shrink {
+static const int UNREACHED = numeric_limits<int>::max();
+static const size_t INITIAL_CACHE_SLOTS = 1024;
+
+FlatMergeAndShrinkRepresentation::FlatMergeAndShrinkRepresentation(
+    const MergeAndShrinkRepresentation &representation,
+    size_t max_cache_bytes)
+    : root(-1),
+      state_buffer(g_variable_domain.size(), -1),
+      cache_epoch(1),
+      num_cache_entries(0),
+      max_cache_bytes(max_cache_bytes),
+      num_cache_hits(0),
+      num_cache_misses(0),
+      num_cache_rejected(0) {
+    root = add_node(representation);
+
+    int num_nodes = nodes.size();
+    min_prices.resize(num_nodes);
+    touched.resize(num_nodes);
+    results.resize(num_nodes);
+    cache_keys.resize(num_nodes);
+    for (int id = 0; id < num_nodes; ++id) {
+        min_prices[id].assign(nodes[id].num_values, UNREACHED);
+        cache_keys[id].resize(nodes[id].cache_idx_variables.size());
+    }
+}
+
+int FlatMergeAndShrinkRepresentation::add_node(
+    const MergeAndShrinkRepresentation &representation) {
+    Node node;
+    size_t table_offset;
+    const auto *atomic =
+        dynamic_cast<const MergeAndShrinkRepresentationLeaf *>(&representation);
+    if (atomic) {
+        node.var = atomic->var_id;
+        node.left_child = -1;
+        node.right_child = -1;
+        node.num_columns = 1;
+        node.use_cache = false;
+        node.exactly_covered_leaf_ids = atomic->exactly_covered_leaf_ids;
+        table_offset = tables.size();
+        tables.insert(tables.end(), atomic->lookup_table.begin(),
+                      atomic->lookup_table.end());
+    } else {
+        const auto &merge =
+            dynamic_cast<const MergeAndShrinkRepresentationMerge &>(representation);
+        node.var = -1;
+        node.left_child = add_node(*merge.left_child);
+        node.right_child = add_node(*merge.right_child);
+        node.num_columns =
+            merge.lookup_table.empty() ? 0 : merge.lookup_table[0].size();
+        node.use_cache = merge.use_cache;
+        node.exactly_covered_leaf_ids = merge.exactly_covered_leaf_ids;
+        node.cache_idx_variables = merge.cache_idx_variables;
+        // children are flattened first, so this node's table follows theirs
+        table_offset = tables.size();
+        for (const vector<int> &row : merge.lookup_table) {
+            tables.insert(tables.end(), row.begin(), row.end());
+        }
+    }
+    node.table_offset = table_offset;
+
+    // Only the root stores distances. Infinite ones are skipped by the lookup
+    // anyway, so they are treated like pruned states.
+    node.num_values = 0;
+    for (size_t i = table_offset; i < tables.size(); ++i) {
+        if (tables[i] == INF) {
+            tables[i] = PRUNED_STATE;
+        } else if (tables[i] != PRUNED_STATE) {
+            node.num_values = max(node.num_values, tables[i] + 1);
+        }
+    }
+
+    nodes.push_back(move(node));
+    return nodes.size() - 1;
+}
+
+size_t FlatMergeAndShrinkRepresentation::compute_cache_hash(
+    int node_id, const int *key) const {
+    utils::HashState hash_state;
+    utils::feed(hash_state, node_id);
+    for (size_t i = 0; i < nodes[node_id].cache_idx_variables.size(); ++i) {
+        utils::feed(hash_state, key[i]);
+    }
+    return hash_state.get_hash64();
+}
+
+bool FlatMergeAndShrinkRepresentation::matches_cache_entry(
+    int node_id, int offset) const {
+    if (cache_arena[offset] != node_id) {
+        return false;
+    }
+    const vector<int> &key = cache_keys[node_id];
+    return equal(key.begin(), key.end(), cache_arena.begin() + offset + 1);
+}
+
+bool FlatMergeAndShrinkRepresentation::lookup_cache(int node_id) {
+    if (!cache_slots.empty()) {
+        size_t mask = cache_slots.size() - 1;
+        size_t pos = compute_cache_hash(node_id, cache_keys[node_id].data()) & mask;
+        while (cache_slots[pos].epoch == cache_epoch) {
+            int offset = cache_slots[pos].offset;
+            if (matches_cache_entry(node_id, offset)) {
+                int i = offset + 1 + cache_keys[node_id].size();
+                int num_pairs = cache_arena[i++];
+                vector<pair<int, int>> &result = results[node_id];
+                result.clear();
+                for (int j = 0; j < num_pairs; ++j, i += 2) {
+                    result.emplace_back(cache_arena[i], cache_arena[i + 1]);
+                }
+                ++num_cache_hits;
+                return true;
+            }
+            pos = (pos + 1) & mask;
+        }
+    }
+    ++num_cache_misses;
+    return false;
+}
+
+bool FlatMergeAndShrinkRepresentation::grow_cache() {
+    size_t new_size = cache_slots.empty() ? INITIAL_CACHE_SLOTS : 2 * cache_slots.size();
+    if (new_size * sizeof(CacheSlot) + cache_arena.size() * sizeof(int) > max_cache_bytes) {
+        return false;
+    }
+    vector<CacheSlot> old_slots(new_size, CacheSlot{0, -1});
+    old_slots.swap(cache_slots);
+    size_t mask = new_size - 1;
+    for (const CacheSlot &slot : old_slots) {
+        if (slot.epoch == cache_epoch) {
+            int node_id = cache_arena[slot.offset];
+            size_t pos = compute_cache_hash(
+                node_id, cache_arena.data() + slot.offset + 1) & mask;
+            while (cache_slots[pos].epoch == cache_epoch) {
+                pos = (pos + 1) & mask;
+            }
+            cache_slots[pos] = slot;
+        }
+    }
+    return true;
+}
+
+void FlatMergeAndShrinkRepresentation::insert_cache(int node_id) {
+    const vector<int> &key = cache_keys[node_id];
+    const vector<pair<int, int>> &result = results[node_id];
+    size_t entry_size = 2 + key.size() + 2 * result.size();
+    // keep the load factor at most 1/2
+    if (2 * (num_cache_entries + 1) > static_cast<int>(cache_slots.size()) &&
+        !grow_cache()) {
+        ++num_cache_rejected;
+        return;
+    }
+    if ((cache_arena.size() + entry_size) * sizeof(int) +
+        cache_slots.size() * sizeof(CacheSlot) > max_cache_bytes) {
+        ++num_cache_rejected;
+        return;
+    }
+
+    int offset = cache_arena.size();
+    cache_arena.push_back(node_id);
+    cache_arena.insert(cache_arena.end(), key.begin(), key.end());
+    cache_arena.push_back(result.size());
+    for (const auto &[index, price] : result) {
+        cache_arena.push_back(index);
+        cache_arena.push_back(price);
+    }
+
+    size_t mask = cache_slots.size() - 1;
+    size_t pos = compute_cache_hash(node_id, key.data()) & mask;
+    while (cache_slots[pos].epoch == cache_epoch) {
+        pos = (pos + 1) & mask;
+    }
+    cache_slots[pos] = CacheSlot{cache_epoch, offset};
+    ++num_cache_entries;
+}
+
+void FlatMergeAndShrinkRepresentation::clear_cache() {
+    // Slots of older epochs count as empty, so this does not touch the table.
+    cache_arena.clear();
+    num_cache_entries = 0;
+    if (++cache_epoch == 0) {
+        fill(cache_slots.begin(), cache_slots.end(), CacheSlot{0, -1});
+        cache_epoch = 1;
+    }
+}
+
+void FlatMergeAndShrinkRepresentation::add_price(
+    int node_id, int index, int price) {
+    int &min_price = min_prices[node_id][index];
+    if (min_price == UNREACHED) {
+        touched[node_id].push_back(index);
+        min_price = price;
+    } else {
+        min_price = min(min_price, price);
+    }
+}
+
+void FlatMergeAndShrinkRepresentation::compact_result(int node_id) {
+    vector<int> &node_min_prices = min_prices[node_id];
+    vector<pair<int, int>> &result = results[node_id];
+    result.clear();
+    for (int index : touched[node_id]) {
+        result.emplace_back(index, node_min_prices[index]);
+        node_min_prices[index] = UNREACHED;
+    }
+    touched[node_id].clear();
+}
+
+void FlatMergeAndShrinkRepresentation::compute_atomic(
+    int node_id, const ExplicitStateCPG *prices, const vector<int> &state) {
+    const Node &node = nodes[node_id];
+    const int *table = tables.data() + node.table_offset;
+    assert(node.exactly_covered_leaf_ids.size() <= 1);
+    if (node.exactly_covered_leaf_ids.empty()) {
+        int index = table[state[node.var]];
+        if (index != PRUNED_STATE) {
+            add_price(node_id, index, 0);
+        }
+    } else {
+        LeafFactorID leaf = node.exactly_covered_leaf_ids[0];
+        int num_leaf_states = prices->get_number_states(leaf);
+        for (LeafStateHash id(0); id < g_state_registry->size(leaf); ++id) {
+            if (prices->has_leaf_state(id, leaf)) {
+                LeafState l_state = g_state_registry->lookup_leaf_state(id, leaf);
+                int index = table[l_state[node.var]];
+                if (index != PRUNED_STATE) {
+                    add_price(node_id, index, prices->get_cost_of_state(id, leaf));
+                }
+                if (--num_leaf_states == 0) {
+                    break;
+                }
+            }
+        }
+    }
+    compact_result(node_id);
+}
+
+void FlatMergeAndShrinkRepresentation::compute_merge(
+    int node_id, const ExplicitStateCPG *prices, vector<int> &state, int price) {
+    const Node &node = nodes[node_id];
+    compute(node.left_child, prices, state);
+    compute(node.right_child, prices, state);
+    const int *table = tables.data() + node.table_offset;
+    const vector<pair<int, int>> &right_result = results[node.right_child];
+    for (const auto &[left_index, left_price] : results[node.left_child]) {
+        const int *row = table + left_index * node.num_columns;
+        for (const auto &[right_index, right_price] : right_result) {
+            int merge_index = row[right_index];
+            if (merge_index != PRUNED_STATE) {
+                add_price(node_id, merge_index, price + left_price + right_price);
+            }
+        }
+    }
+}
+
+void FlatMergeAndShrinkRepresentation::enumerate_exactly_covered_leaves(
+    int node_id, const ExplicitStateCPG *prices, int i, int price,
+    vector<int> &state) {
+    const Node &node = nodes[node_id];
+    if (i == static_cast<int>(node.exactly_covered_leaf_ids.size())) {
+        compute_merge(node_id, prices, state, price);
+        return;
+    }
+
+    LeafFactorID leaf = node.exactly_covered_leaf_ids[i];
+    int num_leaf_states = prices->get_number_states(leaf);
+    for (LeafStateHash id(0); id < g_state_registry->size(leaf); ++id) {
+        if (prices->has_leaf_state(id, leaf)) {
+            LeafState l_state = g_state_registry->lookup_leaf_state(id, leaf);
+            for (int var : g_leaves[leaf]) {
+                state[var] = l_state[var];
+            }
+            enumerate_exactly_covered_leaves(
+                node_id, prices, i + 1,
+                price + prices->get_cost_of_state(id, leaf), state);
+            if (--num_leaf_states == 0) {
+                break;
+            }
+        }
+    }
+}
+
+void FlatMergeAndShrinkRepresentation::compute(
+    int node_id, const ExplicitStateCPG *prices, vector<int> &state) {
+    const Node &node = nodes[node_id];
+    if (node.var != -1) {
+        compute_atomic(node_id, prices, state);
+        return;
+    }
+
+    if (node.use_cache) {
+        vector<int> &key = cache_keys[node_id];
+        for (size_t i = 0; i < node.cache_idx_variables.size(); ++i) {
+            key[i] = state[node.cache_idx_variables[i]];
+        }
+        if (lookup_cache(node_id)) {
+            return;
+        }
+    }
+
+    if (!node.exactly_covered_leaf_ids.empty()) {
+        enumerate_exactly_covered_leaves(node_id, prices, 0, 0, state);
+    } else {
+        compute_merge(node_id, prices, state, 0);
+    }
+    compact_result(node_id);
+
+    if (node.use_cache) {
+        insert_cache(node_id);
+    }
+}
+
+int FlatMergeAndShrinkRepresentation::compute_decoupled_value_exact(
+    const GlobalState &state) {
+    assert(g_factoring);
+    const ExplicitStateCPG *prices = dynamic_cast<const ExplicitStateCPG *>(
+        CPGStorage::storage->get_cpg(state));
+    for (int var : g_center) {
+        state_buffer[var] = state[var];
+    }
+    compute(root, prices, state_buffer);
+    clear_cache();
+
+    int min_h_and_price = INF;
+    for (const auto &[h, price] : results[root]) {
+        min_h_and_price = min(min_h_and_price, h + price);
+    }
+    return min_h_and_price;
+}
+
+void FlatMergeAndShrinkRepresentation::print_statistics() const {
+    cout << "Flat M&S representation: " << nodes.size() << " nodes, "
+         << tables.size() << " table entries" << endl;
+    cout << "Flat M&S cache hits: " << num_cache_hits
+         << ", misses: " << num_cache_misses
+         << ", rejected by memory limit: " << num_cache_rejected << endl;
+}
+}
@@ -0,0 +1,107 @@
+#ifndef MERGE_AND_SHRINK_FLAT_MERGE_AND_SHRINK_REPRESENTATION_H
+#define MERGE_AND_SHRINK_FLAT_MERGE_AND_SHRINK_REPRESENTATION_H
+
+#include "../leaf_state_id.h"
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+class ExplicitStateCPG;
+class GlobalState;
+
+namespace merge_and_shrink {
+class MergeAndShrinkRepresentation;
+
+/*
+  Flat copy of a merge-and-shrink representation for the exact decoupled
+  lookup. It computes the same values as
+  MergeAndShrinkRepresentation::compute_decoupled_value_exact, but without
+  allocating in the lookup:
+
+  - The lookup tables of all nodes are stored in one contiguous array; merge
+    nodes use row-major tables indexed by the values of their children.
+  - The (abstract state, min price) pairs of a node are accumulated in a dense
+    scratch array indexed by abstract state and compacted into a reusable
+    result vector. Both are kept across evaluations.
+  - The per-evaluation cache of the merge nodes is a single open-addressing
+    table over an arena of ints. Once it would exceed max_cache_bytes, further
+    results are recomputed instead of being cached.
+
+  The source representation must have been prepared for the EXACT lookup
+  (set_exactly_covered_leaf_ids with cache variables) before flattening.
+*/
+class FlatMergeAndShrinkRepresentation {
+    struct Node {
+        // variable of an atomic node, -1 for merge nodes
+        int var;
+        int left_child;
+        int right_child;
+        int table_offset;
+        int num_columns;
+        // number of entries of the scratch array, i.e. max value + 1
+        int num_values;
+        bool use_cache;
+        std::vector<LeafFactorID> exactly_covered_leaf_ids;
+        std::vector<int> cache_idx_variables;
+    };
+
+    struct CacheSlot {
+        std::uint32_t epoch;
+        int offset;
+    };
+
+    std::vector<Node> nodes;
+    std::vector<int> tables;
+    int root;
+
+    // per-node scratch, indexed by abstract state resp. reused across calls
+    std::vector<std::vector<int>> min_prices;
+    std::vector<std::vector<int>> touched;
+    std::vector<std::vector<std::pair<int, int>>> results;
+    std::vector<std::vector<int>> cache_keys;
+    std::vector<int> state_buffer;
+
+    // entries: node, key values, number of pairs, (index, price) pairs
+    std::vector<int> cache_arena;
+    std::vector<CacheSlot> cache_slots;
+    std::uint32_t cache_epoch;
+    int num_cache_entries;
+    std::size_t max_cache_bytes;
+
+    long long num_cache_hits;
+    long long num_cache_misses;
+    long long num_cache_rejected;
+
+    int add_node(const MergeAndShrinkRepresentation &representation);
+
+    std::size_t compute_cache_hash(int node_id, const int *key) const;
+    bool matches_cache_entry(int node_id, int offset) const;
+    bool lookup_cache(int node_id);
+    bool grow_cache();
+    void insert_cache(int node_id);
+    void clear_cache();
+
+    void add_price(int node_id, int index, int price);
+    void compact_result(int node_id);
+    void compute_atomic(int node_id, const ExplicitStateCPG *prices,
+                        const std::vector<int> &state);
+    void compute_merge(int node_id, const ExplicitStateCPG *prices,
+                       std::vector<int> &state, int price);
+    void enumerate_exactly_covered_leaves(
+        int node_id, const ExplicitStateCPG *prices, int i, int price,
+        std::vector<int> &state);
+    void compute(int node_id, const ExplicitStateCPG *prices,
+                 std::vector<int> &state);
+public:
+    FlatMergeAndShrinkRepresentation(
+        const MergeAndShrinkRepresentation &representation,
+        std::size_t max_cache_bytes);
+
+    int compute_decoupled_value_exact(const GlobalState &state);
+
+    void print_statistics() const;
+};
+}
+
+#endif
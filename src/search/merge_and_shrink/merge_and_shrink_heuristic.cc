@@ -2,6 +2,7 @@
 
 #include "distances.h"
 #include "factored_transition_system.h"
+#include "flat_merge_and_shrink_representation.h"
 #include "merge_and_shrink_algorithm.h"
 #include "merge_and_shrink_representation.h"
 #include "transition_system.h"
@@ -10,15 +11,18 @@
 #include "../globals.h"
 #include "../option_parser.h"
 #include "../plugin.h"
+#include "../state.h"
 
 #include "../tasks/root_task.h"
 #include "../task_utils/task_properties.h"
 
 #include "../utils/markup.h"
 #include "../utils/system.h"
+#include "../utils/timer.h"
 
 #include <cassert>
 #include <iostream>
+#include <memory>
 #include <utility>
 
 using namespace std;
@@ -27,7 +31,13 @@ using utils::ExitCode;
 namespace merge_and_shrink {
 MergeAndShrinkHeuristic::MergeAndShrinkHeuristic(const options::Options &opts)
     : Heuristic(opts),
-      decoupled_lookup(opts.get<DECOUPLED_LOOKUP>("decoupled_lookup")) {
+      decoupled_lookup(opts.get<DECOUPLED_LOOKUP>("decoupled_lookup")),
+      flat_cache_memory(opts.get<int>("flat_cache_memory")),
+      verify_flat_lookup(opts.get<bool>("verify_flat_lookup")),
+      num_verified_lookups(0),
+      exact_lookup_time(0),
+      flat_lookup_time(0),
+      precomputed(false) {
     log << "Initializing merge-and-shrink heuristic..." << endl;
     MergeAndShrinkAlgorithm algorithm(opts);
     // TODO: switch back to task of heuristic
@@ -35,13 +45,69 @@ MergeAndShrinkHeuristic::MergeAndShrinkHeuristic(const options::Options &opts)
     FactoredTransitionSystem fts = algorithm.build_factored_transition_system(task_proxy);
     extract_factors(fts);
     log << "Done initializing merge-and-shrink heuristic." << endl << endl;
-    if (decoupled_lookup == DECOUPLED_LOOKUP::EXACT){
+    if (decoupled_lookup == DECOUPLED_LOOKUP::EXACT ||
+        decoupled_lookup == DECOUPLED_LOOKUP::EXACT_FLAT) {
         for (auto &mas_representation : mas_representations){
             mas_representation->enable_cache();
         }
     }
 }
 
+MergeAndShrinkHeuristic::~MergeAndShrinkHeuristic() {
+}
+
+bool MergeAndShrinkHeuristic::supports_concurrent_evaluation() const {
+    // The ICAPS'23 lookup registers leaf states in the state registry.
+    return !g_factoring || decoupled_lookup != DECOUPLED_LOOKUP::EXACT_ICAPS23;
+}
+
+void MergeAndShrinkHeuristic::print_statistics() const {
+    for (const auto &flat_representation : flat_representations) {
+        flat_representation->print_statistics();
+    }
+    if (num_verified_lookups > 0) {
+        cout << "Verified exact_flat lookups: " << num_verified_lookups << endl;
+        cout << "Exact lookup time: " << exact_lookup_time << "s" << endl;
+        cout << "Exact_flat lookup time: " << flat_lookup_time << "s" << endl;
+        if (exact_lookup_time > 0 && flat_lookup_time > 0) {
+            cout << "Exact lookups per second: "
+                 << num_verified_lookups / exact_lookup_time << endl;
+            cout << "Exact_flat lookups per second: "
+                 << num_verified_lookups / flat_lookup_time << endl;
+            cout << "Exact_flat lookup speedup: "
+                 << exact_lookup_time / flat_lookup_time << endl;
+        }
+    }
+}
+
+int MergeAndShrinkHeuristic::compute_verified_flat_value(const GlobalState &ancestor_state) {
+    /*
+      Unlike the unverified lookup, we do not stop at the first dead end, so
+      that all representations are compared. A lookup is the evaluation of
+      one representation.
+    */
+    int heuristic = 0;
+    for (size_t i = 0; i < mas_representations.size(); ++i) {
+        utils::Timer flat_timer;
+        int flat_cost = flat_representations[i]->compute_decoupled_value_exact(ancestor_state);
+        flat_lookup_time += flat_timer();
+        utils::Timer exact_timer;
+        int exact_cost = mas_representations[i]->compute_decoupled_value_exact(ancestor_state);
+        exact_lookup_time += exact_timer();
+        ++num_verified_lookups;
+        if (flat_cost != exact_cost) {
+            cerr << "exact_flat lookup of representation " << i << " returned "
+                 << flat_cost << ", exact lookup returned " << exact_cost
+                 << " for state " << ancestor_state.get_id() << endl;
+            utils::exit_with(ExitCode::SEARCH_CRITICAL_ERROR);
+        }
+        if (heuristic != DEAD_END) {
+            heuristic = (flat_cost == INF) ? DEAD_END : max(heuristic, flat_cost);
+        }
+    }
+    return heuristic;
+}
+
 void MergeAndShrinkHeuristic::extract_factor(
     FactoredTransitionSystem &fts, int index) {
     /*
@@ -122,12 +188,10 @@ void MergeAndShrinkHeuristic::extract_factors(FactoredTransitionSystem &fts) {
 }
 
 int MergeAndShrinkHeuristic::compute_heuristic(const GlobalState &ancestor_state) {
-    static bool precomputed = false;
     if (!precomputed && g_factoring) {
         // TODO fix this!
         // this might need to be done in the first call to compute_heuristic due to dependencies to data structures
-        // otherwise not being initialized. It should definitely go into a separate function, though, and not use
-        // this static flag.
+        // otherwise not being initialized. It should definitely go into a separate function, though.
         if (decoupled_lookup == DECOUPLED_LOOKUP::EXACT_NOCACHE ||
             decoupled_lookup == DECOUPLED_LOOKUP::EXACT_STRONGLY_COMPLIANT_MERGING) {
             for (const unique_ptr<MergeAndShrinkRepresentation> &mas_representation: mas_representations) {
@@ -137,7 +201,8 @@ int MergeAndShrinkHeuristic::compute_heuristic(const GlobalState &ancestor_state
                 vector<bool> vars_up_to_node(g_variable_domain.size(), false);
                 mas_representation->set_exactly_covered_leaf_ids(contained_vars, vars_up_to_node, false);
             }
-        } else if (decoupled_lookup == DECOUPLED_LOOKUP::EXACT) {
+        } else if (decoupled_lookup == DECOUPLED_LOOKUP::EXACT ||
+                   decoupled_lookup == DECOUPLED_LOOKUP::EXACT_FLAT) {
             int max_nesting_all = 0;
             for (unique_ptr<MergeAndShrinkRepresentation> &mas_representation: mas_representations) {
                 // Compute variables contained in M&S representation.
@@ -164,6 +229,16 @@ int MergeAndShrinkHeuristic::compute_heuristic(const GlobalState &ancestor_state
                 }
             }
             cout << "Maximum nestedness of all leaves (non-compliance): " << max_nesting_all << endl;
+            if (decoupled_lookup == DECOUPLED_LOOKUP::EXACT_FLAT) {
+                // The memory limit of the cache is shared among all representations.
+                size_t max_cache_bytes = static_cast<size_t>(flat_cache_memory) * 1024 * 1024 /
+                    max<size_t>(mas_representations.size(), 1);
+                for (const unique_ptr<MergeAndShrinkRepresentation> &mas_representation: mas_representations) {
+                    flat_representations.push_back(
+                        make_unique<FlatMergeAndShrinkRepresentation>(
+                            *mas_representation, max_cache_bytes));
+                }
+            }
         } else if (decoupled_lookup == DECOUPLED_LOOKUP::EXACT_ICAPS23 || decoupled_lookup == DECOUPLED_LOOKUP::EXPLICIT){
             for (const unique_ptr<MergeAndShrinkRepresentation> &mas_representation: mas_representations) {
                 vector<bool> contained_vars(g_variable_domain.size(), false);
@@ -174,6 +249,19 @@ int MergeAndShrinkHeuristic::compute_heuristic(const GlobalState &ancestor_state
         precomputed = true;
     }
     int heuristic = 0;
+    if (g_factoring && decoupled_lookup == DECOUPLED_LOOKUP::EXACT_FLAT) {
+        if (verify_flat_lookup) {
+            return compute_verified_flat_value(ancestor_state);
+        }
+        for (const unique_ptr<FlatMergeAndShrinkRepresentation> &flat_representation : flat_representations) {
+            int cost = flat_representation->compute_decoupled_value_exact(ancestor_state);
+            if (cost == INF) {
+                return DEAD_END;
+            }
+            heuristic = max(heuristic, cost);
+        }
+        return heuristic;
+    }
     for (const unique_ptr<MergeAndShrinkRepresentation> &mas_representation : mas_representations) {
         int cost;
         if (g_factoring) {
@@ -295,6 +383,7 @@ static shared_ptr<Heuristic> _parse(options::OptionParser &parser) {
     decoupled_lookup_names.emplace_back("exact_icaps23");
     decoupled_lookup_names.emplace_back("exact");
     decoupled_lookup_names.emplace_back("exact_nocache");
+    decoupled_lookup_names.emplace_back("exact_flat");
     decoupled_lookup_names.emplace_back("exact_strongly_compliant_merging");
     decoupled_lookup_names.emplace_back("explicit");
     vector<string> decoupled_lookup_docs;
@@ -305,6 +394,9 @@ static shared_ptr<Heuristic> _parse(options::OptionParser &parser) {
             "prices once a leaf is fully covered, caching these estimates");
     decoupled_lookup_docs.emplace_back(
             "same as EXACT, but without caching");
+    decoupled_lookup_docs.emplace_back(
+            "same as EXACT, but on a flat copy of the representations using dense "
+            "scratch arrays and an open-addressing cache bounded by flat_cache_memory");
     decoupled_lookup_docs.emplace_back(
             "track full product of partial leaf states until leaf is fully "
             "covered by M&S representation - only for merge strategies strongly compliant "
@@ -317,6 +409,18 @@ static shared_ptr<Heuristic> _parse(options::OptionParser &parser) {
             "choose how to do the decoupled lookup",
             "exact_icaps23",
             decoupled_lookup_docs);
+    parser.add_option<int>(
+            "flat_cache_memory",
+            "memory limit in MiB for the caches of decoupled_lookup=exact_flat, "
+            "shared among all factors",
+            "512",
+            options::Bounds("0", "infinity"));
+    parser.add_option<bool>(
+            "verify_flat_lookup",
+            "with decoupled_lookup=exact_flat, also compute every value with the "
+            "exact lookup on the same representation, abort if the values differ "
+            "and print the lookups per second of both",
+            "false");
 
     Heuristic::add_options_to_parser(parser);
     add_merge_and_shrink_algorithm_options_to_parser(parser);
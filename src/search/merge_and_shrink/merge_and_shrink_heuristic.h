@@ -7,12 +7,14 @@
 
 namespace merge_and_shrink {
 class FactoredTransitionSystem;
+class FlatMergeAndShrinkRepresentation;
 class MergeAndShrinkRepresentation;
 
 enum class DECOUPLED_LOOKUP {
     EXACT_ICAPS23, // TODO remove this eventually
     EXACT,
     EXACT_NOCACHE,
+    EXACT_FLAT,
     EXACT_STRONGLY_COMPLIANT_MERGING, // TODO this can probably be removed if EXACT turns out to give the same performance
     EXPLICIT
 };
@@ -21,15 +23,35 @@ class MergeAndShrinkHeuristic : public Heuristic {
 
     // The final merge-and-shrink representations, storing goal distances.
     std::vector<std::unique_ptr<MergeAndShrinkRepresentation>> mas_representations;
+    // Flat copies of mas_representations for DECOUPLED_LOOKUP::EXACT_FLAT.
+    std::vector<std::unique_ptr<FlatMergeAndShrinkRepresentation>> flat_representations;
+    const int flat_cache_memory;
+    /*
+      With decoupled_lookup=exact_flat, also compute every value with the
+      exact lookup on the same representation, abort if they differ and
+      time both lookups.
+    */
+    const bool verify_flat_lookup;
+    long long num_verified_lookups;
+    double exact_lookup_time;
+    double flat_lookup_time;
+    // true once the representations are prepared for the decoupled lookup
+    bool precomputed;
 
     void extract_factor(FactoredTransitionSystem &fts, int index);
     bool extract_unsolvable_factor(FactoredTransitionSystem &fts);
     void extract_nontrivial_factors(FactoredTransitionSystem &fts);
     void extract_factors(FactoredTransitionSystem &fts);
+    int compute_verified_flat_value(const GlobalState &ancestor_state);
 protected:
     virtual int compute_heuristic(const GlobalState &ancestor_state) override;
 public:
     explicit MergeAndShrinkHeuristic(const options::Options &opts);
+    virtual ~MergeAndShrinkHeuristic() override;
+
+    virtual bool supports_concurrent_evaluation() const override;
+
+    virtual void print_statistics() const override;
 };
 }
 
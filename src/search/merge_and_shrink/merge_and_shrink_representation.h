@@ -83,6 +83,8 @@ public:
 
 
 class MergeAndShrinkRepresentationLeaf : public MergeAndShrinkRepresentation {
+    friend class FlatMergeAndShrinkRepresentation;
+
     const int var_id;
     std::vector<int> lookup_table;
 public:
@@ -127,6 +129,8 @@ public:
 
 
 class MergeAndShrinkRepresentationMerge : public MergeAndShrinkRepresentation {
+    friend class FlatMergeAndShrinkRepresentation;
+
     std::unique_ptr<MergeAndShrinkRepresentation> left_child;
     std::unique_ptr<MergeAndShrinkRepresentation> right_child;
     std::vector<std::vector<int>> lookup_table;
@@ -13,6 +13,9 @@
 
 #include "../utils/logging.h"
 #include "../utils/markup.h"
+#include "../utils/thread_pool.h"
+
+#include <functional>
 
 using namespace std;
 
@@ -24,48 +27,79 @@ MergeScoringFunctionMIASM::MergeScoringFunctionMIASM(
       max_states_before_merge(options.get<int>("max_states_before_merge")),
       shrink_threshold_before_merge(options.get<int>("threshold_before_merge")),
       silent_log(utils::get_silent_log()) {
+    int num_threads = options.get<int>("threads");
+    if (num_threads > 1) {
+        if (shrink_strategy->uses_random_numbers()) {
+            utils::g_log << "MIASM: the shrink strategy uses random numbers, "
+                         << "scoring merge candidates sequentially" << endl;
+        } else {
+            thread_pool = utils::make_unique_ptr<utils::ThreadPool>(num_threads);
+        }
+    }
 }
 
-vector<double> MergeScoringFunctionMIASM::compute_scores(
+MergeScoringFunctionMIASM::~MergeScoringFunctionMIASM() {
+}
+
+double MergeScoringFunctionMIASM::compute_score(
     const FactoredTransitionSystem &fts,
-    const vector<pair<int, int>> &merge_candidates) {
-    vector<double> scores;
-    scores.reserve(merge_candidates.size());
-    for (pair<int, int> merge_candidate : merge_candidates) {
-        int index1 = merge_candidate.first;
-        int index2 = merge_candidate.second;
-        unique_ptr<TransitionSystem> product = shrink_before_merge_externally(
-            fts,
-            index1,
-            index2,
-            *shrink_strategy,
-            max_states,
-            max_states_before_merge,
-            shrink_threshold_before_merge,
-            silent_log);
-
-        // Compute distances for the product and count the alive states.
-        unique_ptr<Distances> distances = utils::make_unique_ptr<Distances>(*product);
-        const bool compute_init_distances = true;
-        const bool compute_goal_distances = true;
-        distances->compute_distances(compute_init_distances, compute_goal_distances, silent_log);
-        int num_states = product->get_size();
-        int alive_states_count = 0;
-        for (int state = 0; state < num_states; ++state) {
-            if (distances->get_init_distance(state) != INF &&
-                distances->get_goal_distance(state) != INF) {
-                ++alive_states_count;
-            }
+    pair<int, int> merge_candidate,
+    utils::LogProxy &log) const {
+    int index1 = merge_candidate.first;
+    int index2 = merge_candidate.second;
+    unique_ptr<TransitionSystem> product = shrink_before_merge_externally(
+        fts,
+        index1,
+        index2,
+        *shrink_strategy,
+        max_states,
+        max_states_before_merge,
+        shrink_threshold_before_merge,
+        log);
+
+    // Compute distances for the product and count the alive states.
+    unique_ptr<Distances> distances = utils::make_unique_ptr<Distances>(*product);
+    const bool compute_init_distances = true;
+    const bool compute_goal_distances = true;
+    distances->compute_distances(compute_init_distances, compute_goal_distances, log);
+    int num_states = product->get_size();
+    int alive_states_count = 0;
+    for (int state = 0; state < num_states; ++state) {
+        if (distances->get_init_distance(state) != INF &&
+            distances->get_goal_distance(state) != INF) {
+            ++alive_states_count;
         }
+    }
 
+    /*
+      Compute the score as the ratio of alive states of the product
+      compared to the number of states of the full product.
+    */
+    assert(num_states);
+    return static_cast<double>(alive_states_count) /
+           static_cast<double>(num_states);
+}
+
+vector<double> MergeScoringFunctionMIASM::compute_scores(
+    const FactoredTransitionSystem &fts,
+    const vector<pair<int, int>> &merge_candidates) {
+    vector<double> scores(merge_candidates.size());
+    if (thread_pool) {
         /*
-          Compute the score as the ratio of alive states of the product
-          compared to the number of states of the full product.
+          The products are computed from copies of the factors, so the
+          candidates can be scored independently. Every task writes only the
+          score of its candidate, which makes the scores independent of the
+          scheduling. Log proxies are not shared between threads.
         */
-        assert(num_states);
-        double score = static_cast<double>(alive_states_count) /
-            static_cast<double>(num_states);
-        scores.push_back(score);
+        function<void(size_t)> task = [&](size_t i) {
+            utils::LogProxy task_log = utils::get_silent_log();
+            scores[i] = compute_score(fts, merge_candidates[i], task_log);
+        };
+        thread_pool->run(merge_candidates.size(), task);
+    } else {
+        for (size_t i = 0; i < merge_candidates.size(); ++i) {
+            scores[i] = compute_score(fts, merge_candidates[i], silent_log);
+        }
     }
     return scores;
 }
@@ -74,6 +108,14 @@ string MergeScoringFunctionMIASM::name() const {
     return "miasm";
 }
 
+void MergeScoringFunctionMIASM::dump_function_specific_options(
+    utils::LogProxy &log) const {
+    if (log.is_at_least_normal()) {
+        log << "Threads: " << (thread_pool ? thread_pool->get_num_threads() : 1)
+            << endl;
+    }
+}
+
 static shared_ptr<MergeScoringFunction>_parse(options::OptionParser &parser) {
     parser.document_synopsis(
         "MIASM",
@@ -127,6 +169,14 @@ static shared_ptr<MergeScoringFunction>_parse(options::OptionParser &parser) {
         "We recommend setting this to match the shrink strategy configuration "
         "given to {{{merge_and_shrink}}}, see note below.");
     add_transition_system_size_limit_options_to_parser(parser);
+    parser.add_option<int>(
+        "threads",
+        "number of threads that compute the products of the merge candidates "
+        "concurrently. The scores do not depend on the number of threads. "
+        "Shrink strategies that use random numbers (e.g. {{{shrink_fh}}}) "
+        "always score the candidates sequentially.",
+        "1",
+        options::Bounds("1", "infinity"));
     // TODO: this is only necessary for handle_shrink_limit_options_defaults.
     utils::add_log_options_to_parser(parser);
 
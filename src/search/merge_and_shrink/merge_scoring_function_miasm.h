@@ -7,6 +7,10 @@
 
 #include <memory>
 
+namespace utils {
+class ThreadPool;
+}
+
 namespace merge_and_shrink {
 class ShrinkStrategy;
 class MergeScoringFunctionMIASM : public MergeScoringFunction {
@@ -15,11 +19,19 @@ class MergeScoringFunctionMIASM : public MergeScoringFunction {
     const int max_states_before_merge;
     const int shrink_threshold_before_merge;
     utils::LogProxy silent_log;
+    // scores the merge candidates concurrently if set (threads > 1)
+    std::unique_ptr<utils::ThreadPool> thread_pool;
+
+    double compute_score(
+        const FactoredTransitionSystem &fts,
+        std::pair<int, int> merge_candidate,
+        utils::LogProxy &log) const;
 protected:
     virtual std::string name() const override;
+    virtual void dump_function_specific_options(utils::LogProxy &log) const override;
 public:
     explicit MergeScoringFunctionMIASM(const options::Options &options);
-    virtual ~MergeScoringFunctionMIASM() override = default;
+    virtual ~MergeScoringFunctionMIASM() override;
     virtual std::vector<double> compute_scores(
         const FactoredTransitionSystem &fts,
         const std::vector<std::pair<int, int>> &merge_candidates) override;
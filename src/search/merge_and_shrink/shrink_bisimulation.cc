@@ -12,9 +12,11 @@
 #include "../utils/logging.h"
 #include "../utils/markup.h"
 #include "../utils/system.h"
+#include "../utils/thread_pool.h"
 
 #include <algorithm>
 #include <cassert>
+#include <functional>
 #include <limits>
 #include <iostream>
 #include <memory>
@@ -96,9 +98,60 @@ struct Signature {
 };
 
 
+/*
+  Call task(begin, end) for num_chunks consecutive ranges of [0, size) on the
+  threads of the pool.
+*/
+static void run_on_chunks(
+    utils::ThreadPool &pool, size_t size, size_t num_chunks,
+    const function<void(size_t, size_t)> &task) {
+    size_t chunk_size = (size + num_chunks - 1) / num_chunks;
+    function<void(size_t)> chunk_task = [&](size_t chunk) {
+        size_t begin = min(chunk * chunk_size, size);
+        size_t end = min(begin + chunk_size, size);
+        task(begin, end);
+    };
+    pool.run(num_chunks, chunk_task);
+}
+
+/*
+  Sort the chunks of the signatures concurrently and merge them pairwise.
+  Signature::operator< is a total order (no two signatures compare equal
+  because they differ in their states or, for the sentinels, in h_and_goal),
+  so the result is identical to sorting sequentially.
+*/
+static void sort_signatures(vector<Signature> &signatures, utils::ThreadPool &pool) {
+    size_t num_chunks = pool.get_num_threads();
+    size_t chunk_size = (signatures.size() + num_chunks - 1) / num_chunks;
+    auto chunk_start = [&](size_t chunk) {
+        return signatures.begin() + min(chunk * chunk_size, signatures.size());
+    };
+    function<void(size_t, size_t)> sort_chunk = [&](size_t begin, size_t end) {
+        ::sort(signatures.begin() + begin, signatures.begin() + end);
+    };
+    run_on_chunks(pool, signatures.size(), num_chunks, sort_chunk);
+    for (size_t width = 1; width < num_chunks; width *= 2) {
+        size_t num_merges = (num_chunks + 2 * width - 1) / (2 * width);
+        function<void(size_t)> merge_task = [&](size_t merge) {
+            size_t first = 2 * width * merge;
+            size_t middle = min(first + width, num_chunks);
+            size_t last = min(first + 2 * width, num_chunks);
+            inplace_merge(chunk_start(first), chunk_start(middle), chunk_start(last));
+        };
+        pool.run(num_merges, merge_task);
+    }
+}
+
 ShrinkBisimulation::ShrinkBisimulation(const Options &opts)
     : greedy(opts.get<bool>("greedy")),
       at_limit(opts.get<AtLimit>("at_limit")) {
+    int num_threads = opts.get<int>("threads");
+    if (num_threads > 1) {
+        thread_pool = utils::make_unique_ptr<utils::ThreadPool>(num_threads);
+    }
+}
+
+ShrinkBisimulation::~ShrinkBisimulation() {
 }
 
 int ShrinkBisimulation::initialize_groups(
@@ -143,7 +196,8 @@ void ShrinkBisimulation::compute_signatures(
     const TransitionSystem &ts,
     const Distances &distances,
     vector<Signature> &signatures,
-    const vector<int> &state_to_group) const {
+    const vector<int> &state_to_group,
+    utils::ThreadPool *pool) const {
     assert(signatures.empty());
 
     // Step 1: Compute bare state signatures (without transition information).
@@ -227,16 +281,26 @@ void ShrinkBisimulation::compute_signatures(
        4. Two signatures compare equal according to Signature::operator<
           iff we don't want to distinguish their states in the current
           bisimulation round.
+
+       Both steps give the same result with and without a thread pool.
      */
 
-    for (size_t i = 0; i < signatures.size(); ++i) {
-        SuccessorSignature &succ_sig = signatures[i].succ_signature;
-        ::sort(succ_sig.begin(), succ_sig.end());
-        succ_sig.erase(::unique(succ_sig.begin(), succ_sig.end()),
-                       succ_sig.end());
+    function<void(size_t, size_t)> canonicalize = [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            SuccessorSignature &succ_sig = signatures[i].succ_signature;
+            ::sort(succ_sig.begin(), succ_sig.end());
+            succ_sig.erase(::unique(succ_sig.begin(), succ_sig.end()),
+                           succ_sig.end());
+        }
+    };
+
+    if (pool) {
+        run_on_chunks(*pool, signatures.size(), pool->get_num_threads(), canonicalize);
+        sort_signatures(signatures, *pool);
+    } else {
+        canonicalize(0, signatures.size());
+        ::sort(signatures.begin(), signatures.end());
     }
-
-    ::sort(signatures.begin(), signatures.end());
 }
 
 StateEquivalenceRelation ShrinkBisimulation::compute_equivalence_relation(
@@ -251,6 +315,17 @@ StateEquivalenceRelation ShrinkBisimulation::compute_equivalence_relation(
     vector<Signature> signatures;
     signatures.reserve(num_states + 2);
 
+    /*
+      Only split the signature computation if no other thread uses the pool
+      at the moment. Refining the groups below depends on the order of the
+      signatures and is therefore done sequentially.
+    */
+    unique_lock<mutex> pool_lock(thread_pool_mutex, defer_lock);
+    utils::ThreadPool *pool = nullptr;
+    if (thread_pool && pool_lock.try_lock()) {
+        pool = thread_pool.get();
+    }
+
     int num_groups = initialize_groups(ts, distances, state_to_group);
     // log << "number of initial groups: " << num_groups << endl;
 
@@ -263,7 +338,7 @@ StateEquivalenceRelation ShrinkBisimulation::compute_equivalence_relation(
         stable = true;
 
         signatures.clear();
-        compute_signatures(ts, distances, signatures, state_to_group);
+        compute_signatures(ts, distances, signatures, state_to_group, pool);
 
         // Verify size of signatures and presence of sentinels.
         assert(static_cast<int>(signatures.size()) == num_states + 2);
@@ -377,6 +452,8 @@ void ShrinkBisimulation::dump_strategy_specific_options(utils::LogProxy &log) co
             ABORT("Unknown setting for at_limit.");
         }
         log << endl;
+        log << "Threads: " << (thread_pool ? thread_pool->get_num_threads() : 1)
+            << endl;
     }
 }
 
@@ -424,6 +501,13 @@ static shared_ptr<ShrinkStrategy>_parse(OptionParser &parser) {
     parser.add_enum_option<AtLimit>(
         "at_limit", at_limit,
         "what to do when the size limit is hit", "RETURN");
+    parser.add_option<int>(
+        "threads",
+        "number of threads that canonicalize and sort the state signatures "
+        "in each refinement step. The result does not depend on the number "
+        "of threads.",
+        "1",
+        Bounds("1", "infinity"));
 
     Options opts = parser.parse();
 
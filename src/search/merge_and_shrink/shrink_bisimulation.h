@@ -3,10 +3,17 @@
 
 #include "shrink_strategy.h"
 
+#include <memory>
+#include <mutex>
+
 namespace options {
 class Options;
 }
 
+namespace utils {
+class ThreadPool;
+}
+
 namespace merge_and_shrink {
 struct Signature;
 
@@ -18,6 +25,13 @@ enum class AtLimit {
 class ShrinkBisimulation : public ShrinkStrategy {
     const bool greedy;
     const AtLimit at_limit;
+    /*
+      Canonicalizes and sorts the signatures concurrently if set
+      (threads > 1). The strategy may be used by several threads (e.g. by
+      sf_miasm), but only one of them can use the pool at a time.
+    */
+    std::unique_ptr<utils::ThreadPool> thread_pool;
+    mutable std::mutex thread_pool_mutex;
 
     void compute_abstraction(
         const TransitionSystem &ts,
@@ -34,13 +48,14 @@ class ShrinkBisimulation : public ShrinkStrategy {
         const TransitionSystem &ts,
         const Distances &distances,
         std::vector<Signature> &signatures,
-        const std::vector<int> &state_to_group) const;
+        const std::vector<int> &state_to_group,
+        utils::ThreadPool *pool) const;
 protected:
     virtual void dump_strategy_specific_options(utils::LogProxy &log) const override;
     virtual std::string name() const override;
 public:
     explicit ShrinkBisimulation(const options::Options &opts);
-    virtual ~ShrinkBisimulation() override = default;
+    virtual ~ShrinkBisimulation() override;
     virtual StateEquivalenceRelation compute_equivalence_relation(
         const TransitionSystem &ts,
         const Distances &distances,
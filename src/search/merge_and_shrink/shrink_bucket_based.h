@@ -58,6 +58,9 @@ public:
         const Distances &distances,
         int target_size,
         utils::LogProxy &log) const override;
+    virtual bool uses_random_numbers() const override {
+        return true;
+    }
     static void add_options_to_parser(options::OptionParser &parser);
 };
 }
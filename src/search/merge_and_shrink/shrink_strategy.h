@@ -44,6 +44,15 @@ public:
     virtual bool requires_init_distances() const = 0;
     virtual bool requires_goal_distances() const = 0;
 
+    /*
+      Return true if the computed equivalence relations depend on a random
+      number generator. Such strategies must not be used by several threads
+      concurrently if the results should be reproducible.
+    */
+    virtual bool uses_random_numbers() const {
+        return false;
+    }
+
     void dump_options(utils::LogProxy &log) const;
     std::string get_name() const;
 };
@@ -1,5 +1,6 @@
 #include "mutex_group.h"
 
+#include "binary_input.h"
 #include "globals.h"
 #include "abstract_task.h" //For FactPair
 
@@ -23,6 +24,16 @@ MutexGroup::MutexGroup(istream &in) : detected_fw(true), exactly_one(false) {
     // detected_fw = (dir == "fw");
 }
 
+MutexGroup::MutexGroup(BinaryInput &in) : detected_fw(true), exactly_one(false) {
+    int num_facts = in.read_int();
+    facts.reserve(num_facts);
+    for (int j = 0; j < num_facts; ++j) {
+        int var = in.read_int();
+        int val = in.read_int();
+        facts.push_back(FactPair(var, val));
+    }
+}
+
 bool MutexGroup::hasPair(int var, int val) const {
     for (size_t i = 0; i < facts.size(); ++i) {
         if (facts[i].var == var && facts[i].value == val) {
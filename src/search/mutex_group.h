@@ -4,6 +4,7 @@
 #include <iostream>
 #include <vector>
 
+class BinaryInput;
 struct FactPair;
 
 class MutexGroup {
@@ -13,6 +14,7 @@ class MutexGroup {
     std::vector<FactPair> facts;
 public:
     MutexGroup(std::istream &in);
+    MutexGroup(BinaryInput &in);
 
     void dump() const;
 
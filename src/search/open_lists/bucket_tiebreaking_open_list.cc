@@ -0,0 +1,183 @@
+// HACK! Ignore this if used as a top-level compile target.
+#ifdef OPEN_LISTS_BUCKET_TIEBREAKING_OPEN_LIST_H
+
+#include "../evaluator.h"
+#include "../option_parser.h"
+#include "../utils/system.h"
+
+#include <cassert>
+#include <iostream>
+#include <limits>
+
+using namespace std;
+
+/*
+  Tie-breaking open list for exactly two evaluators with non-negative
+  values, e.g. [f, h] in A*. Entries are stored in two levels of buckets
+  indexed by [first value][second value]. Both levels are hash maps that
+  only hold the values that currently have entries, and the smallest
+  value is kept in a min-heap of these keys. Memory and the search for the
+  minimum therefore depend on the number of distinct values, not on their
+  magnitude, so large action costs are fine. Insertion into an existing
+  bucket is a hash lookup; the heaps are only updated when a value gets
+  its first or loses its last entry. Within a bucket, entries are expanded
+  in FIFO or LIFO order.
+
+  States that any evaluator regards as dead ends are not inserted.
+*/
+
+template<class Entry>
+shared_ptr<OpenList<Entry>> BucketTieBreakingOpenList<Entry>::_parse(OptionParser &parser) {
+    parser.document_synopsis(
+        "Bucket-based tie-breaking open list",
+        "Tie-breaking open list for two evaluators with non-negative integer "
+        "values, implemented as two levels of buckets. Only values that "
+        "currently have entries are stored.");
+    parser.add_list_option<shared_ptr<Evaluator>>("evals", "two scalar evaluators");
+    parser.add_option<bool>(
+        "pref_only",
+        "insert only nodes generated by preferred operators", "false");
+    parser.add_option<bool>(
+        "lifo",
+        "expand entries with equal values in LIFO instead of FIFO order",
+        "false");
+    Options opts = parser.parse();
+    if (!parser.dry_run() &&
+        opts.get_list<shared_ptr<Evaluator>>("evals").size() != 2) {
+        parser.error("bucket-based tie-breaking open list needs exactly two evaluators");
+    }
+    if (parser.dry_run())
+        return 0;
+    else
+        return make_shared<BucketTieBreakingOpenList<Entry>>(opts);
+}
+
+template<class Entry>
+BucketTieBreakingOpenList<Entry>::BucketTieBreakingOpenList(const Options &opts)
+    : BucketTieBreakingOpenList(opts.get_list<shared_ptr<Evaluator>>("evals"),
+                                opts.get<bool>("pref_only"),
+                                opts.get<bool>("lifo")) {
+}
+
+template<class Entry>
+BucketTieBreakingOpenList<Entry>::BucketTieBreakingOpenList(
+    const std::vector<shared_ptr<Evaluator>> &evals,
+    bool preferred_only, bool lifo)
+    : OpenList<Entry>(preferred_only),
+      size(0), lifo(lifo),
+      evaluators(evals) {
+    assert(evaluators.size() == 2);
+}
+
+template<class Entry>
+int BucketTieBreakingOpenList<Entry>::insert(const Entry &entry) {
+    if (OpenList<Entry>::only_preferred && !last_preferred)
+        return 0;
+    if (dead_end)
+        return 0;
+    int row_key = last_evaluated_value[0];
+    int bucket_key = last_evaluated_value[1];
+    if (row_key < 0 || bucket_key < 0) {
+        cerr << "bucket-based open list requires non-negative evaluator values"
+             << endl;
+        utils::exit_with(utils::ExitCode::SEARCH_CRITICAL_ERROR);
+    }
+    auto row_it = rows.find(row_key);
+    if (row_it == rows.end()) {
+        row_it = rows.emplace(row_key, Row()).first;
+        row_keys.push(row_key);
+    }
+    Row &row = row_it->second;
+    auto bucket_it = row.buckets.find(bucket_key);
+    if (bucket_it == row.buckets.end()) {
+        bucket_it = row.buckets.emplace(bucket_key, Bucket()).first;
+        row.bucket_keys.push(bucket_key);
+    }
+    bucket_it->second.push_back(entry);
+    ++size;
+    return 1;
+}
+
+template<class Entry>
+Entry BucketTieBreakingOpenList<Entry>::remove_min(vector<int> *key) {
+    assert(size > 0);
+    int row_key = row_keys.top();
+    auto row_it = rows.find(row_key);
+    assert(row_it != rows.end());
+    Row &row = row_it->second;
+    int bucket_key = row.bucket_keys.top();
+    auto bucket_it = row.buckets.find(bucket_key);
+    assert(bucket_it != row.buckets.end() && !bucket_it->second.empty());
+    if (key) {
+        assert(key->empty());
+        key->push_back(row_key);
+        key->push_back(bucket_key);
+    }
+    Bucket &bucket = bucket_it->second;
+    Entry result = lifo ? bucket.back() : bucket.front();
+    if (lifo)
+        bucket.pop_back();
+    else
+        bucket.pop_front();
+    if (bucket.empty()) {
+        row.buckets.erase(bucket_it);
+        row.bucket_keys.pop();
+        if (row.buckets.empty()) {
+            rows.erase(row_it);
+            row_keys.pop();
+        }
+    }
+    --size;
+    return result;
+}
+
+template<class Entry>
+bool BucketTieBreakingOpenList<Entry>::empty() const {
+    return size == 0;
+}
+
+template<class Entry>
+void BucketTieBreakingOpenList<Entry>::clear() {
+    rows.clear();
+    row_keys = KeyHeap();
+    size = 0;
+}
+
+template<class Entry>
+void BucketTieBreakingOpenList<Entry>::evaluate(int g, bool preferred) {
+    dead_end = false;
+    dead_end_reliable = false;
+
+    for (size_t i = 0; i < evaluators.size(); ++i) {
+        evaluators[i]->evaluate(g, preferred);
+
+        if (evaluators[i]->is_dead_end()) {
+            last_evaluated_value[i] = numeric_limits<int>::max();
+            dead_end = true;
+            if (evaluators[i]->dead_end_is_reliable()) {
+                dead_end_reliable = true;
+            }
+        } else {
+            last_evaluated_value[i] = evaluators[i]->get_value();
+        }
+    }
+    last_preferred = preferred;
+}
+
+template<class Entry>
+bool BucketTieBreakingOpenList<Entry>::is_dead_end() const {
+    return dead_end;
+}
+
+template<class Entry>
+bool BucketTieBreakingOpenList<Entry>::dead_end_is_reliable() const {
+    return dead_end_reliable;
+}
+
+template<class Entry>
+void BucketTieBreakingOpenList<Entry>::get_involved_heuristics(std::set<Heuristic*> &hset) {
+    for (size_t i = 0; i < evaluators.size(); ++i) {
+        evaluators[i]->get_involved_heuristics(hset);
+    }
+}
+#endif
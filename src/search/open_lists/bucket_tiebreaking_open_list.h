@@ -0,0 +1,71 @@
+#ifndef OPEN_LISTS_BUCKET_TIEBREAKING_OPEN_LIST_H
+#define OPEN_LISTS_BUCKET_TIEBREAKING_OPEN_LIST_H
+
+#include "open_list.h"
+#include "../evaluator.h"
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+
+class Evaluator;
+
+namespace options {
+class Options;
+class OptionParser;
+}
+
+template<class Entry>
+class BucketTieBreakingOpenList : public OpenList<Entry> {
+    typedef std::deque<Entry> Bucket;
+    // min-heap of the keys of the non-empty rows or buckets
+    typedef std::priority_queue<int, std::vector<int>, std::greater<int>> KeyHeap;
+
+    struct Row {
+        std::unordered_map<int, Bucket> buckets;
+        KeyHeap bucket_keys;
+    };
+
+    // rows indexed by the first, buckets by the second evaluator value;
+    // only non-empty rows and buckets are stored
+    std::unordered_map<int, Row> rows;
+    KeyHeap row_keys;
+    int size;
+    bool lifo;
+
+    std::vector<std::shared_ptr<Evaluator>> evaluators;
+    int last_evaluated_value[2];
+    bool last_preferred;
+    bool dead_end;
+    bool dead_end_reliable;
+protected:
+    Evaluator* get_evaluator() {return this; }
+
+public:
+    BucketTieBreakingOpenList(const options::Options &opts);
+    BucketTieBreakingOpenList(const std::vector<std::shared_ptr<Evaluator>> &evals,
+                              bool preferred_only, bool lifo);
+
+    // open list interface
+    int insert(const Entry &entry);
+    Entry remove_min(std::vector<int> *key = 0);
+    bool empty() const;
+    void clear();
+
+    // tuple evaluator interface
+    void evaluate(int g, bool preferred);
+    bool is_dead_end() const;
+    bool dead_end_is_reliable() const;
+    void get_involved_heuristics(std::set<Heuristic*> &hset);
+
+    static std::shared_ptr<OpenList<Entry>> _parse(options::OptionParser &parser);
+};
+
+#include "bucket_tiebreaking_open_list.cc"
+
+// HACK! Need a better strategy of dealing with templates, also in the Makefile.
+
+#endif
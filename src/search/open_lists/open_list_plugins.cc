@@ -1,6 +1,7 @@
 #include "open_list_plugins.h"
 
 #include "alternation_open_list.h"
+#include "bucket_tiebreaking_open_list.h"
 #include "standard_scalar_open_list.h"
 #include "tiebreaking_open_list.h"
 
@@ -53,9 +54,22 @@ static shared_ptr<OpenList<StateID>> _parse_tiebreaking_openlist_stateid(OptionP
         return make_shared<TieBreakingOpenList<StateID>>(opts);
 }
 
+static shared_ptr<OpenList<StateID>> _parse_bucket_tiebreaking_openlist_stateid(OptionParser &parser) {
+    parser.document_synopsis("Bucket-based tie-breaking open list with StateID",
+            "HACK: this plugin exists only to let the option parser registry"
+            "know about the templated open list.");
+
+    Options opts = parser.parse();
+    if (parser.dry_run())
+        return 0;
+    else
+        return make_shared<BucketTieBreakingOpenList<StateID>>(opts);
+}
+
 static Plugin<OpenList<StateID>> _plugin_alternation_openlist_stateid("never_use_this1", _parse_alternation_openlist_stateid);
 static Plugin<OpenList<StateID>> _plugin_standard_scalar_openlist_stateid("never_use_this2", _parse_standard_scalar_openlist_stateid);
 static Plugin<OpenList<StateID>> _plugin_tiebreaking_openlist_stateid("never_use_this3", _parse_tiebreaking_openlist_stateid);
+static Plugin<OpenList<StateID>> _plugin_bucket_tiebreaking_openlist_stateid("never_use_this6", _parse_bucket_tiebreaking_openlist_stateid);
 
 
 static PluginTypePlugin<OpenList<OpenListEntryLazy>> _type_plugin_openlist_entrylazy(
@@ -1,5 +1,6 @@
 #include "operator.h"
 
+#include "binary_input.h"
 #include "compliant_paths/compliant_path_graph.h"
 #include "compliant_paths/cpg_storage.h"
 #include "factoring.h"
@@ -56,6 +57,23 @@ void Operator::read_pre_post(istream &in) {
     effects.push_back(Effect(var, post, conditions));
 }
 
+void Operator::read_pre_post(BinaryInput &in) {
+    int cond_count = in.read_int();
+    vector<Condition> conditions;
+    conditions.reserve(cond_count);
+    for (int i = 0; i < cond_count; ++i) {
+        int var = in.read_int();
+        int val = in.read_int();
+        conditions.push_back(Condition(var, val));
+    }
+    int var = in.read_int();
+    int pre = in.read_int();
+    int post = in.read_int();
+    if (pre != -1)
+        preconditions.push_back(Condition(var, pre));
+    effects.push_back(Effect(var, post, conditions));
+}
+
 Operator::Operator(istream &in, bool axiom) {
     marked = false;
     dead = false;
@@ -90,6 +108,37 @@ Operator::Operator(istream &in, bool axiom) {
     }
 }
 
+Operator::Operator(BinaryInput &in, bool axiom) {
+    marked = false;
+    dead = false;
+
+    is_an_axiom = axiom;
+    if (!is_an_axiom) {
+        name = in.read_string();
+        int count = in.read_int();
+        preconditions.reserve(count);
+        for (int i = 0; i < count; ++i) {
+            int var = in.read_int();
+            int val = in.read_int();
+            preconditions.push_back(Condition(var, val));
+        }
+        count = in.read_int();
+        effects.reserve(count);
+        for (int i = 0; i < count; ++i)
+            read_pre_post(in);
+
+        int op_cost = in.read_int();
+        cost = g_use_metric ? op_cost : 1;
+
+        g_min_action_cost = min(g_min_action_cost, cost);
+        g_max_action_cost = max(g_max_action_cost, cost);
+    } else {
+        name = "<axiom>";
+        cost = 0;
+        read_pre_post(in);
+    }
+}
+
 bool Operator::is_applicable(const GlobalState &state) const {
     if (g_factoring){
         if (!is_center_applicable(state)){
@@ -14,6 +14,7 @@
 #include <string>
 #include <vector>
 
+class BinaryInput;
 
 struct Condition {
     int var;
@@ -96,11 +97,13 @@ class Operator {
     bool dead;
 
     void read_pre_post(std::istream &in);
+    void read_pre_post(BinaryInput &in);
 
     void set_affected_factor(LeafFactorID factor);
 
 public:
     explicit Operator(std::istream &in, bool is_axiom);
+    Operator(BinaryInput &in, bool is_axiom);
 
     void dump() const;
 
@@ -26,6 +26,14 @@ public:
         predefined.emplace(key, std::make_pair(std::type_index(typeid(T)), object));
     }
 
+    // Copy the predefinition of key from other, which must contain it.
+    void predefine_from(const std::string &key, const Predefinitions &other) {
+        if (predefined.count(key)) {
+            throw OptionParserError(key + " is already used in a predefinition.");
+        }
+        predefined.emplace(key, other.predefined.at(key));
+    }
+
     bool contains(const std::string &key) const {
         return predefined.find(key) != predefined.end();
     }
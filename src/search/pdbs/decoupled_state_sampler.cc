@@ -0,0 +1,524 @@
+#include "decoupled_state_sampler.h"
+
+#include "pattern_filter.h"
+
+#include "../globals.h"
+#include "../operator.h"
+
+#include "../cost_saturation/cost_partitioning_heuristic.h"
+#include "../cost_saturation/projection.h"
+#include "../cost_saturation/utils.h"
+
+#include "../utils/logging.h"
+#include "../utils/rng.h"
+#include "../utils/system.h"
+#include "../utils/timer.h"
+
+#include <algorithm>
+#include <cassert>
+#include <functional>
+#include <numeric>
+#include <queue>
+#include <unordered_set>
+
+using namespace cost_saturation;
+using namespace std;
+
+namespace pdbs {
+static bool satisfies_preconditions(
+    const Operator &op, LeafFactorID factor, const vector<int> &values) {
+    for (const Condition &pre : op.get_preconditions(factor)) {
+        int value = (factor == LeafFactorID::CENTER) ? values[pre.var] : values[g_new_index[pre.var]];
+        if (value != pre.val) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void apply_effects(
+    const Operator &op, LeafFactorID factor, vector<int> &values) {
+    for (const Effect &eff : op.get_effects(factor)) {
+        // no need to check does_fire here, because no conditional effects allowed (yet)
+        if (factor == LeafFactorID::CENTER) {
+            values[eff.var] = eff.val;
+        } else {
+            values[g_new_index[eff.var]] = eff.val;
+        }
+    }
+}
+
+DecoupledStateSampler::DecoupledStateSampler(
+    const Abstractions &abstractions,
+    const vector<int> &operator_costs,
+    const shared_ptr<utils::RandomNumberGenerator> &rng)
+    : abstractions(abstractions),
+      operator_costs(operator_costs),
+      rng(rng),
+      average_operator_cost(0),
+      num_samples(0),
+      num_walk_steps(0),
+      num_restarts(0),
+      sampling_time(0),
+      max_thread_leaf_states(0) {
+    assert(g_factoring);
+    assert(operator_costs.size() == g_operators.size());
+    if (!operator_costs.empty()) {
+        average_operator_cost = accumulate(
+            operator_costs.begin(), operator_costs.end(), 0.0) / operator_costs.size();
+    }
+
+    abstractions_by_leaf.resize(g_leaves.size());
+    for (int id = 0; id < static_cast<int>(abstractions.size()); ++id) {
+        const Projection *projection = dynamic_cast<const Projection *>(abstractions[id].get());
+        assert(projection);
+        unordered_set<LeafFactorID> affected_leaves = get_leaf_factors_of_pattern(projection->get_pattern());
+        assert(affected_leaves.size() <= 1);
+        if (affected_leaves.empty()) {
+            leaf_of_abstraction.push_back(LeafFactorID::CENTER);
+            column_of_abstraction.push_back(-1);
+        } else {
+            LeafFactorID leaf = *affected_leaves.begin();
+            leaf_of_abstraction.push_back(leaf);
+            column_of_abstraction.push_back(abstractions_by_leaf[leaf].size());
+            abstractions_by_leaf[leaf].push_back(id);
+        }
+    }
+
+    leaf_ops.resize(g_leaves.size());
+    leaves_by_center_precondition_var.resize(g_variable_domain.size());
+    for (int op_id = 0; op_id < static_cast<int>(g_operators.size()); ++op_id) {
+        const Operator &op = g_operators[op_id];
+        if (op.is_dead()) {
+            continue;
+        }
+        LeafFactorID factor = op.get_affected_factor();
+        if (factor == LeafFactorID::CENTER) {
+            center_ops.push_back(op_id);
+            continue;
+        }
+        for (LeafFactorID pre_factor : op.get_leaf_pre_factors()) {
+            if (pre_factor != factor) {
+                cerr << "Decoupled samples do not support leaf operators with "
+                     << "preconditions on other leaves: " << op.get_name() << endl;
+                utils::exit_with(utils::ExitCode::SEARCH_UNSUPPORTED);
+            }
+        }
+        leaf_ops[factor].push_back(op_id);
+        for (const Condition &pre : op.get_preconditions(LeafFactorID::CENTER)) {
+            vector<LeafFactorID> &leaves = leaves_by_center_precondition_var[pre.var];
+            if (leaves.empty() || leaves.back() != factor) {
+                leaves.push_back(factor);
+            }
+        }
+    }
+
+    leaf_states.resize(g_leaves.size());
+    leaf_state_ids.resize(g_leaves.size());
+    initial_state.center = g_initial_state_data;
+    initial_state.prices.resize(g_leaves.size());
+    for (LeafFactorID leaf(0); leaf < g_leaves.size(); ++leaf) {
+        vector<int> values;
+        values.reserve(g_leaves[leaf].size());
+        for (int var : g_leaves[leaf]) {
+            values.push_back(g_initial_state_data[var]);
+        }
+        initial_state.prices[leaf][get_leaf_state_id(leaf, values)] = 0;
+        compute_prices(initial_state, leaf);
+    }
+    is_leaf_to_update.resize(g_leaves.size(), false);
+}
+
+DecoupledStateSampler::DecoupledStateSampler(
+    const DecoupledStateSampler &other,
+    const shared_ptr<utils::RandomNumberGenerator> &rng)
+    : abstractions(other.abstractions),
+      operator_costs(other.operator_costs),
+      rng(rng),
+      average_operator_cost(other.average_operator_cost),
+      leaf_of_abstraction(other.leaf_of_abstraction),
+      abstractions_by_leaf(other.abstractions_by_leaf),
+      column_of_abstraction(other.column_of_abstraction),
+      center_ops(other.center_ops),
+      leaf_ops(other.leaf_ops),
+      leaves_by_center_precondition_var(other.leaves_by_center_precondition_var),
+      leaf_states(other.leaf_states),
+      leaf_state_ids(other.leaf_state_ids),
+      initial_state(other.initial_state),
+      is_leaf_to_update(other.is_leaf_to_update.size(), false),
+      num_samples(0),
+      num_walk_steps(0),
+      num_restarts(0),
+      sampling_time(0),
+      max_thread_leaf_states(0) {
+}
+
+int DecoupledStateSampler::get_leaf_state_id(
+    LeafFactorID leaf, const vector<int> &values) {
+    auto it = leaf_state_ids[leaf].find(values);
+    if (it != leaf_state_ids[leaf].end()) {
+        return it->second;
+    }
+    int id = leaf_states[leaf].size();
+    leaf_states[leaf].push_back(values);
+    leaf_state_ids[leaf].emplace(values, id);
+    return id;
+}
+
+size_t DecoupledStateSampler::get_num_leaf_states() const {
+    size_t num_leaf_states = 0;
+    for (const auto &states : leaf_states) {
+        num_leaf_states += states.size();
+    }
+    return num_leaf_states;
+}
+
+bool DecoupledStateSampler::is_applicable(
+    const DecoupledState &state, const Operator &op) const {
+    if (!satisfies_preconditions(op, LeafFactorID::CENTER, state.center)) {
+        return false;
+    }
+    for (LeafFactorID leaf : op.get_leaf_pre_factors()) {
+        bool applicable = false;
+        for (const auto &id_and_price : state.prices[leaf]) {
+            if (satisfies_preconditions(op, leaf, leaf_states[leaf][id_and_price.first])) {
+                applicable = true;
+                break;
+            }
+        }
+        if (!applicable) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void DecoupledStateSampler::compute_prices(DecoupledState &state, LeafFactorID leaf) {
+    if (leaf_ops[leaf].empty()) {
+        return;
+    }
+    using Entry = pair<int, int>;
+    // Dijkstra over the leaf actions applicable with the center state
+    unordered_map<int, int> &prices = state.prices[leaf];
+    priority_queue<Entry, vector<Entry>, greater<Entry>> queue;
+    for (const auto &id_and_price : prices) {
+        queue.emplace(id_and_price.second, id_and_price.first);
+    }
+    while (!queue.empty()) {
+        int price = queue.top().first;
+        int id = queue.top().second;
+        queue.pop();
+        if (prices[id] < price) {
+            continue;
+        }
+        // copy, registering successors may reallocate the leaf states
+        const vector<int> values = leaf_states[leaf][id];
+        for (int op_id : leaf_ops[leaf]) {
+            const Operator &op = g_operators[op_id];
+            if (!satisfies_preconditions(op, LeafFactorID::CENTER, state.center) ||
+                !satisfies_preconditions(op, leaf, values)) {
+                continue;
+            }
+            vector<int> successor = values;
+            apply_effects(op, leaf, successor);
+            int successor_id = get_leaf_state_id(leaf, successor);
+            int successor_price = price + operator_costs[op_id];
+            auto it = prices.find(successor_id);
+            if (it == prices.end() || successor_price < it->second) {
+                prices[successor_id] = successor_price;
+                queue.emplace(successor_price, successor_id);
+            }
+        }
+    }
+}
+
+/*
+  Applies the center operator op in place. Only the prices of the leaves
+  that op restricts or changes and of the leaves with leaf operators that
+  depend on a changed center variable are recomputed, the prices of all
+  other leaves stay the same.
+*/
+void DecoupledStateSampler::apply_operator(DecoupledState &state, const Operator &op) {
+    fill(is_leaf_to_update.begin(), is_leaf_to_update.end(), false);
+    for (LeafFactorID leaf : op.get_leaf_pre_factors()) {
+        is_leaf_to_update[leaf] = true;
+    }
+    for (LeafFactorID leaf : op.get_leaf_effect_factors()) {
+        is_leaf_to_update[leaf] = true;
+    }
+    for (LeafFactorID leaf(0); leaf < g_leaves.size(); ++leaf) {
+        if (!is_leaf_to_update[leaf]) {
+            continue;
+        }
+        // keep the leaf states compliant with op, applying its leaf effects
+        unordered_map<int, int> prices;
+        for (const auto &id_and_price : state.prices[leaf]) {
+            vector<int> values = leaf_states[leaf][id_and_price.first];
+            if (!satisfies_preconditions(op, leaf, values)) {
+                continue;
+            }
+            apply_effects(op, leaf, values);
+            int id = get_leaf_state_id(leaf, values);
+            auto it = prices.find(id);
+            if (it == prices.end() || id_and_price.second < it->second) {
+                prices[id] = id_and_price.second;
+            }
+        }
+        state.prices[leaf].swap(prices);
+    }
+    for (const Effect &eff : op.get_effects(LeafFactorID::CENTER)) {
+        if (state.center[eff.var] != eff.val) {
+            state.center[eff.var] = eff.val;
+            for (LeafFactorID leaf : leaves_by_center_precondition_var[eff.var]) {
+                is_leaf_to_update[leaf] = true;
+            }
+        }
+    }
+    for (LeafFactorID leaf(0); leaf < g_leaves.size(); ++leaf) {
+        if (is_leaf_to_update[leaf]) {
+            compute_prices(state, leaf);
+        }
+    }
+}
+
+vector<int> DecoupledStateSampler::get_representative(
+    const DecoupledState &state) const {
+    // The representative is the center state with the cheapest leaf states.
+    vector<int> concrete_state = state.center;
+    for (LeafFactorID leaf(0); leaf < g_leaves.size(); ++leaf) {
+        assert(!state.prices[leaf].empty());
+        auto cheapest = min_element(
+            state.prices[leaf].begin(), state.prices[leaf].end(),
+            [](const pair<const int, int> &lhs, const pair<const int, int> &rhs) {
+                return lhs.second < rhs.second ||
+                       (lhs.second == rhs.second && lhs.first < rhs.first);
+            });
+        const vector<int> &values = leaf_states[leaf][cheapest->first];
+        for (size_t i = 0; i < values.size(); ++i) {
+            concrete_state[g_leaves[leaf][i]] = values[i];
+        }
+    }
+    return concrete_state;
+}
+
+/*
+  Equivalent to create_sample(state).compute_heuristic(cp_heuristic) == INF,
+  but only looks up the abstract states of the abstractions with a lookup
+  table and stores no sample.
+*/
+bool DecoupledStateSampler::is_dead_end(
+    const DecoupledState &state, const CostPartitioningHeuristic &cp_heuristic) const {
+    vector<int> concrete_state = get_representative(state);
+    vector<vector<const CostPartitioningHeuristic::LookupTable *>> tables_by_leaf(
+        g_leaves.size());
+    for (const auto &lookup_table : cp_heuristic.lookup_tables) {
+        int id = lookup_table.abstraction_id;
+        LeafFactorID leaf = leaf_of_abstraction[id];
+        if (leaf == LeafFactorID::CENTER) {
+            int abstract_state_id = abstractions[id]->get_abstract_state_id(concrete_state);
+            if (lookup_table.h_values[abstract_state_id] == INF) {
+                return true;
+            }
+        } else {
+            tables_by_leaf[leaf].push_back(&lookup_table);
+        }
+    }
+    // A leaf is a dead end if all of its reached leaf states are.
+    for (LeafFactorID leaf(0); leaf < g_leaves.size(); ++leaf) {
+        const auto &tables = tables_by_leaf[leaf];
+        if (tables.empty()) {
+            continue;
+        }
+        vector<int> member_state = concrete_state;
+        bool has_solvable_member = false;
+        for (const auto &id_and_price : state.prices[leaf]) {
+            const vector<int> &values = leaf_states[leaf][id_and_price.first];
+            for (size_t i = 0; i < values.size(); ++i) {
+                member_state[g_leaves[leaf][i]] = values[i];
+            }
+            bool is_solvable = all_of(
+                tables.begin(), tables.end(),
+                [&](const CostPartitioningHeuristic::LookupTable *table) {
+                    int abstract_state_id =
+                        abstractions[table->abstraction_id]->get_abstract_state_id(member_state);
+                    return table->h_values[abstract_state_id] != INF;
+                });
+            if (is_solvable) {
+                has_solvable_member = true;
+                break;
+            }
+        }
+        if (!has_solvable_member) {
+            return true;
+        }
+    }
+    return false;
+}
+
+Sample DecoupledStateSampler::create_sample(const DecoupledState &state) const {
+    vector<int> concrete_state = get_representative(state);
+
+    Sample sample;
+    sample.abstract_state_ids = get_abstract_state_ids(abstractions, concrete_state);
+
+    shared_ptr<DecoupledSample> decoupled_sample = make_shared<DecoupledSample>();
+    decoupled_sample->center_ids.resize(abstractions.size(), -1);
+    for (size_t id = 0; id < abstractions.size(); ++id) {
+        if (leaf_of_abstraction[id] == LeafFactorID::CENTER) {
+            decoupled_sample->center_ids[id] = sample.abstract_state_ids[id];
+        }
+    }
+    decoupled_sample->prices.resize(g_leaves.size());
+    decoupled_sample->leaf_ids.resize(g_leaves.size());
+    for (LeafFactorID leaf(0); leaf < g_leaves.size(); ++leaf) {
+        const vector<int> &leaf_abstractions = abstractions_by_leaf[leaf];
+        if (leaf_abstractions.empty()) {
+            continue;
+        }
+        vector<int> member_state = concrete_state;
+        vector<int> &prices = decoupled_sample->prices[leaf];
+        vector<int> &ids = decoupled_sample->leaf_ids[leaf];
+        prices.reserve(state.prices[leaf].size());
+        ids.reserve(state.prices[leaf].size() * leaf_abstractions.size());
+        for (const auto &id_and_price : state.prices[leaf]) {
+            const vector<int> &values = leaf_states[leaf][id_and_price.first];
+            for (size_t i = 0; i < values.size(); ++i) {
+                member_state[g_leaves[leaf][i]] = values[i];
+            }
+            prices.push_back(id_and_price.second);
+            for (int id : leaf_abstractions) {
+                ids.push_back(abstractions[id]->get_abstract_state_id(member_state));
+            }
+        }
+    }
+
+    sample.evaluate = [this, decoupled_sample](const CostPartitioningHeuristic &cp_heuristic) {
+            return evaluate(*decoupled_sample, cp_heuristic);
+        };
+    return sample;
+}
+
+int DecoupledStateSampler::evaluate(
+    const DecoupledSample &sample, const CostPartitioningHeuristic &cp_heuristic) const {
+    int sum_h = 0;
+    // sum of price and h values for every reached leaf state
+    vector<vector<int>> member_sums = sample.prices;
+    for (const auto &lookup_table : cp_heuristic.lookup_tables) {
+        int id = lookup_table.abstraction_id;
+        LeafFactorID leaf = leaf_of_abstraction[id];
+        if (leaf == LeafFactorID::CENTER) {
+            int h = lookup_table.h_values[sample.center_ids[id]];
+            if (h == INF) {
+                return INF;
+            }
+            sum_h += h;
+        } else {
+            vector<int> &sums = member_sums[leaf];
+            const vector<int> &ids = sample.leaf_ids[leaf];
+            size_t num_columns = abstractions_by_leaf[leaf].size();
+            size_t column = column_of_abstraction[id];
+            for (size_t member = 0; member < sums.size(); ++member) {
+                if (sums[member] == INF) {
+                    continue;
+                }
+                int h = lookup_table.h_values[ids[member * num_columns + column]];
+                sums[member] = (h == INF) ? INF : sums[member] + h;
+            }
+        }
+    }
+    for (LeafFactorID leaf(0); leaf < g_leaves.size(); ++leaf) {
+        if (abstractions_by_leaf[leaf].empty()) {
+            continue;
+        }
+        int min_sum = *min_element(member_sums[leaf].begin(), member_sums[leaf].end());
+        if (min_sum == INF) {
+            // all reached leaf states are dead-ends
+            return INF;
+        }
+        sum_h += min_sum;
+    }
+    return sum_h;
+}
+
+Sample DecoupledStateSampler::get_initial_sample() {
+    return create_sample(initial_state);
+}
+
+Sample DecoupledStateSampler::sample_state(
+    int init_h, const CostPartitioningHeuristic &cp_for_init) {
+    assert(init_h != INF);
+    utils::Timer timer;
+    // Walk length as in sampling::RandomWalkSampler.
+    int n;
+    if (init_h == 0) {
+        n = 10;
+    } else {
+        assert(average_operator_cost != 0);
+        int solution_steps_estimate = int((init_h / average_operator_cost) + 0.5);
+        n = 4 * solution_steps_estimate;
+    }
+    int length = 0;
+    for (int j = 0; j < n; ++j) {
+        if (rng->random() < 0.5) {
+            ++length;
+        }
+    }
+
+    DecoupledState current_state = initial_state;
+    vector<int> applicable_ops;
+    for (int j = 0; j < length; ++j) {
+        applicable_ops.clear();
+        for (int op_id : center_ops) {
+            if (is_applicable(current_state, g_operators[op_id])) {
+                applicable_ops.push_back(op_id);
+            }
+        }
+        // If there are no applicable operators, do not walk further.
+        if (applicable_ops.empty()) {
+            break;
+        }
+        int op_id = *rng->choose(applicable_ops);
+        apply_operator(current_state, g_operators[op_id]);
+        ++num_walk_steps;
+        // Restart from the initial state in dead ends.
+        if (is_dead_end(current_state, cp_for_init)) {
+            current_state = initial_state;
+            ++num_restarts;
+        }
+    }
+    Sample sample = create_sample(current_state);
+    ++num_samples;
+    sampling_time += timer();
+    return sample;
+}
+
+unique_ptr<StateSampler> DecoupledStateSampler::create_thread_sampler(
+    const shared_ptr<utils::RandomNumberGenerator> &rng) const {
+    return unique_ptr<StateSampler>(new DecoupledStateSampler(*this, rng));
+}
+
+void DecoupledStateSampler::add_statistics(const StateSampler &thread_sampler) {
+    const DecoupledStateSampler &other =
+        static_cast<const DecoupledStateSampler &>(thread_sampler);
+    num_samples += other.num_samples;
+    num_walk_steps += other.num_walk_steps;
+    num_restarts += other.num_restarts;
+    sampling_time += other.sampling_time;
+    max_thread_leaf_states = max(max_thread_leaf_states, other.get_num_leaf_states());
+}
+
+void DecoupledStateSampler::print_statistics() const {
+    // thread samplers number their leaf states separately
+    size_t num_leaf_states = max(get_num_leaf_states(), max_thread_leaf_states);
+    utils::g_log << "Decoupled samples: " << num_samples << endl;
+    utils::g_log << "Decoupled random walk steps: " << num_walk_steps << endl;
+    utils::g_log << "Decoupled random walk restarts: " << num_restarts << endl;
+    utils::g_log << "Leaf states reached by decoupled random walks: "
+                 << num_leaf_states << endl;
+    utils::g_log << "Decoupled sampling time: " << sampling_time << "s" << endl;
+    if (sampling_time > 0) {
+        utils::g_log << "Decoupled samples per second: "
+                     << num_samples / sampling_time << endl;
+    }
+}
+}
@@ -0,0 +1,134 @@
+#ifndef PDBS_DECOUPLED_STATE_SAMPLER_H
+#define PDBS_DECOUPLED_STATE_SAMPLER_H
+
+#include "../leaf_state_id.h"
+
+#include "../cost_saturation/state_sampler.h"
+#include "../cost_saturation/types.h"
+
+#include "../utils/hash.h"
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+class Operator;
+
+namespace utils {
+class RandomNumberGenerator;
+}
+
+namespace pdbs {
+/*
+  Sample decoupled states for computing the orders of
+  MaxSCPHeuristicSingleLeaf. The random walks apply center actions, starting
+  in the initial decoupled state, and every decoupled state stores the
+  reached leaf states of each leaf with their prices like Prices does: the
+  cost of the cheapest leaf path that complies with the center path.
+
+  The orders are computed while the heuristic is constructed, i.e., before
+  the search engine sets up the compliant path graphs and registers the leaf
+  states of the initial state. We therefore compute the prices here and
+  number the leaf states locally.
+
+  Leaf operators only have preconditions on the center and their own leaf:
+  the factoring turns operators with preconditions on other leaves into
+  center operators (general factorings). Center operators may have
+  preconditions and effects on several leaves.
+
+  A sample is evaluated like MaxSCPHeuristicSingleLeaf evaluates decoupled
+  states: the h values of the patterns over center variables are summed, and
+  every leaf affected by a pattern adds the minimum over its reached leaf
+  states of the price plus the h values of the patterns affecting the leaf.
+  Every pattern may affect at most one leaf.
+*/
+class DecoupledStateSampler : public cost_saturation::StateSampler {
+    struct DecoupledState {
+        // indexed by variable, only the values of center variables are set
+        std::vector<int> center;
+        // prices of the reached leaf states by local leaf state id, per leaf
+        std::vector<std::unordered_map<int, int>> prices;
+    };
+
+    struct DecoupledSample {
+        // abstract state id for patterns over center variables only, else -1
+        std::vector<int> center_ids;
+        // prices of the reached leaf states of each affected leaf
+        std::vector<std::vector<int>> prices;
+        /*
+          For each affected leaf, the abstract state ids of the patterns
+          affecting the leaf, one row per reached leaf state.
+        */
+        std::vector<std::vector<int>> leaf_ids;
+    };
+
+    const cost_saturation::Abstractions &abstractions;
+    const std::vector<int> operator_costs;
+    const std::shared_ptr<utils::RandomNumberGenerator> rng;
+    double average_operator_cost;
+
+    // leaf affected by each abstraction (CENTER if none)
+    std::vector<LeafFactorID> leaf_of_abstraction;
+    // abstractions affecting each leaf and the position of each abstraction
+    // in the rows of its leaf
+    std::vector<std::vector<int>> abstractions_by_leaf;
+    std::vector<int> column_of_abstraction;
+
+    std::vector<int> center_ops;
+    std::vector<std::vector<int>> leaf_ops;
+    // leaves with leaf operators that have a precondition on the variable
+    std::vector<std::vector<LeafFactorID>> leaves_by_center_precondition_var;
+
+    // values of the leaf variables (in the order of g_leaves) by local id
+    std::vector<std::vector<std::vector<int>>> leaf_states;
+    std::vector<utils::HashMap<std::vector<int>, int>> leaf_state_ids;
+
+    DecoupledState initial_state;
+    // leaves whose prices apply_operator recomputes
+    std::vector<bool> is_leaf_to_update;
+
+    int num_samples;
+    uint64_t num_walk_steps;
+    int num_restarts;
+    double sampling_time;
+    // maximum number of leaf states numbered by a thread sampler
+    size_t max_thread_leaf_states;
+
+    // copy of other for another thread, without statistics
+    DecoupledStateSampler(
+        const DecoupledStateSampler &other,
+        const std::shared_ptr<utils::RandomNumberGenerator> &rng);
+
+    int get_leaf_state_id(LeafFactorID leaf, const std::vector<int> &values);
+    size_t get_num_leaf_states() const;
+    bool is_applicable(const DecoupledState &state, const Operator &op) const;
+    void compute_prices(DecoupledState &state, LeafFactorID leaf);
+    void apply_operator(DecoupledState &state, const Operator &op);
+
+    std::vector<int> get_representative(const DecoupledState &state) const;
+    bool is_dead_end(const DecoupledState &state,
+                     const cost_saturation::CostPartitioningHeuristic &cp_heuristic) const;
+    cost_saturation::Sample create_sample(const DecoupledState &state) const;
+    int evaluate(const DecoupledSample &sample,
+                 const cost_saturation::CostPartitioningHeuristic &cp_heuristic) const;
+public:
+    DecoupledStateSampler(
+        const cost_saturation::Abstractions &abstractions,
+        const std::vector<int> &operator_costs,
+        const std::shared_ptr<utils::RandomNumberGenerator> &rng);
+
+    virtual cost_saturation::Sample get_initial_sample() override;
+    virtual cost_saturation::Sample sample_state(
+        int init_h,
+        const cost_saturation::CostPartitioningHeuristic &cp_for_init) override;
+
+    virtual std::unique_ptr<cost_saturation::StateSampler> create_thread_sampler(
+        const std::shared_ptr<utils::RandomNumberGenerator> &rng) const override;
+    virtual void add_statistics(
+        const cost_saturation::StateSampler &thread_sampler) override;
+    virtual void print_statistics() const override;
+};
+}
+
+#endif
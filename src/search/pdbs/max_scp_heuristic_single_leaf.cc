@@ -1,6 +1,7 @@
 #include "max_scp_heuristic_single_leaf.h"
 
 #include "decoupled_pdb_utils.h"
+#include "decoupled_state_sampler.h"
 #include "pattern_filter.h"
 #include "types.h"
 
@@ -21,52 +22,249 @@
 #include "../tasks/root_task.h"
 #include "../task_utils/task_properties.h"
 
+#include "../utils/hash.h"
+#include "../utils/logging.h"
+#include "../utils/memory.h"
+#include "../utils/rng_options.h"
+#include "../utils/timer.h"
+
+#include <numeric>
+#include <unordered_set>
+
 using namespace cost_saturation;
 using namespace std;
 
 namespace pdbs {
+static void verify_pattern_affects_single_leaf(const Pattern &pattern) {
+    if (get_leaf_factors_of_pattern(pattern).size() > 1){
+        cerr << "Every pattern may affect at most one leaf for max SCP single leaf." << endl;
+        utils::exit_with(utils::ExitCode::SEARCH_INPUT_ERROR);
+    }
+}
+
+static void verify_patterns_affect_single_leaf(const Abstractions &abstractions) {
+    for (const unique_ptr<Abstraction> &abstraction : abstractions) {
+        Projection *projection = dynamic_cast<Projection *>(abstraction.get());
+        verify_pattern_affects_single_leaf(projection->get_pattern());
+    }
+}
+
 MaxSCPHeuristicSingleLeaf::MaxSCPHeuristicSingleLeaf(
     const options::Options &opts,
     Abstractions &&abstractions,
     CPHeuristics &&cp_heuristics)
-    : MaxSCPHeuristic(opts, move(abstractions), move(cp_heuristics)) {
+    : MaxSCPHeuristic(opts, move(abstractions), move(cp_heuristics)),
+      min_distance_cache_size(opts.get<int>("min_distance_cache_size")),
+      num_cache_hits(0),
+      num_cache_misses(0),
+      order_pruning_warm_up(opts.get<int>("order_pruning_warm_up")),
+      active_orders(this->cp_heuristics.size()),
+      num_evaluations(0),
+      warm_up_time(0),
+      pruned_time(0),
+      sum_finite_h(0),
+      num_finite_evaluations(0),
+      evaluation_time(0) {
+    iota(active_orders.begin(), active_orders.end(), 0);
+    num_best_order.resize(this->cp_heuristics.size(), 0);
     if (!g_factoring){
         return;
     }
-    // Verify that every pattern affects at most one leaf factor.
-    for (unique_ptr<Abstraction> &abstraction : abstractions) {
-        Projection *projection = dynamic_cast<Projection *>(abstraction.get());
-        unordered_set<LeafFactorID> affected_leaves = get_leaf_factors_of_pattern(projection->get_pattern());
-        if (affected_leaves.size() > 1){
-            cerr << "Every pattern may affect at most one leaf for max SCP single leaf." << endl;
-            utils::exit_with(utils::ExitCode::SEARCH_INPUT_ERROR);
-        }
+    // the parameter abstractions has been moved to the base class
+    for (const Pattern &pattern : patterns) {
+        verify_pattern_affects_single_leaf(pattern);
     }
 
-    vector<bool> is_leaf_pattern(patterns.size(), false);
-    affecting_patterns.resize(g_leaves.size());
-    for (PatternID p_id = 0; p_id < static_cast<int>(patterns.size()); ++p_id) {
+    int num_patterns = patterns.size();
+    vector<LeafFactorID> leaf_of_pattern(num_patterns, LeafFactorID::CENTER);
+    vector<bool> has_center_var(num_patterns, false);
+    for (PatternID p_id = 0; p_id < num_patterns; ++p_id) {
         for (int var : patterns[p_id]){
             LeafFactorID factor = g_belongs_to_factor[var];
             if (factor != LeafFactorID::CENTER){
-                is_leaf_pattern[p_id] = true;
-                affecting_patterns[factor].insert(p_id);
+                leaf_of_pattern[p_id] = factor;
+            } else {
+                has_center_var[p_id] = true;
+            }
+        }
+    }
+
+    is_affected_leaf.resize(g_leaves.size(), false);
+    leaf_tables.resize(g_leaves.size());
+    // position of each mixed pattern in the mixed patterns of its leaf
+    vector<int> mixed_pattern_index(num_patterns, -1);
+    for (PatternID p_id = 0; p_id < num_patterns; ++p_id) {
+        LeafFactorID leaf = leaf_of_pattern[p_id];
+        if (leaf != LeafFactorID::CENTER){
+            is_affected_leaf[leaf] = true;
+            if (has_center_var[p_id]){
+                mixed_pattern_index[p_id] = leaf_tables[leaf].mixed_patterns.size();
+                leaf_tables[leaf].mixed_patterns.push_back(p_id);
+            }
+        }
+    }
+
+    // the parameter cp_heuristics has been moved to the base class
+    int num_orders = this->cp_heuristics.size();
+    mixed_lookups.resize(num_orders, vector<vector<MixedLookup>>(g_leaves.size()));
+    leaf_only_lookups.resize(num_orders, vector<vector<int>>(g_leaves.size()));
+    center_only_lookups.resize(num_orders);
+    for (int order = 0; order < num_orders; ++order) {
+        const auto &lookup_tables = this->cp_heuristics[order].lookup_tables;
+        for (int i = 0; i < static_cast<int>(lookup_tables.size()); ++i) {
+            PatternID p_id = lookup_tables[i].abstraction_id;
+            LeafFactorID leaf = leaf_of_pattern[p_id];
+            if (leaf == LeafFactorID::CENTER) {
+                center_only_lookups[order].push_back(i);
+            } else if (has_center_var[p_id]) {
+                mixed_lookups[order][leaf].push_back({mixed_pattern_index[p_id], i});
+            } else {
+                leaf_only_lookups[order][leaf].push_back(i);
+            }
+        }
+    }
+    center_offsets.resize(num_patterns, 0);
+    cached_min_distances.resize(g_leaves.size(), nullptr);
+}
+
+void MaxSCPHeuristicSingleLeaf::print_statistics() const {
+    MaxSCPHeuristic::print_statistics();
+    if (min_distance_cache_size > 0) {
+        uint64_t num_lookups = num_cache_hits + num_cache_misses;
+        cout << "Min distance cache hits: " << num_cache_hits << "/" << num_lookups
+             << " = " << (num_lookups ? 100. * num_cache_hits / num_lookups : 0.)
+             << "%" << endl;
+    }
+    if (order_pruning_warm_up > 0 && num_evaluations > order_pruning_warm_up) {
+        int num_pruned_evaluations = num_evaluations - order_pruning_warm_up;
+        double avg_warm_up_time = warm_up_time / order_pruning_warm_up;
+        double avg_pruned_time = pruned_time / num_pruned_evaluations;
+        cout << "Evaluations after order pruning: " << num_pruned_evaluations << endl;
+        cout << "Average evaluation time with all orders: " << avg_warm_up_time << "s" << endl;
+        cout << "Average evaluation time with active orders: " << avg_pruned_time << "s" << endl;
+        cout << "Estimated evaluation time saved by order pruning: "
+             << (avg_warm_up_time - avg_pruned_time) * num_pruned_evaluations << "s" << endl;
+    }
+    if (num_evaluations > 0) {
+        double avg_time = evaluation_time / num_evaluations;
+        cout << "Heuristic evaluations: " << num_evaluations << endl;
+        cout << "Average evaluation time: " << avg_time << "s" << endl;
+        if (num_finite_evaluations > 0) {
+            double avg_h = static_cast<double>(sum_finite_h) / num_finite_evaluations;
+            cout << "Average finite h value: " << avg_h << endl;
+            if (avg_time > 0) {
+                cout << "Average finite h value per millisecond of evaluation time: "
+                     << avg_h / (avg_time * 1000) << endl;
             }
         }
     }
-    for (PatternID p_id = 0; p_id < static_cast<int>(patterns.size()); ++p_id){
-        if (!is_leaf_pattern[p_id]){
-            center_only_patterns.insert(p_id);
+}
+
+void MaxSCPHeuristicSingleLeaf::prune_orders() {
+    vector<int> best_orders;
+    for (int order : active_orders) {
+        if (num_best_order[order] > 0) {
+            best_orders.push_back(order);
+        }
+    }
+    if (best_orders.empty()) {
+        cout << "No order was the best order during the warm-up, keeping all orders." << endl;
+        return;
+    }
+    cout << "Active orders after " << num_evaluations << " evaluations: "
+         << best_orders.size() << "/" << active_orders.size() << endl;
+    cout << "Active orders: " << best_orders << endl;
+    active_orders = move(best_orders);
+}
+
+size_t MaxSCPHeuristicSingleLeaf::MinDistanceKeyHash::operator()(const MinDistanceKey &key) const {
+    utils::HashState hash_state;
+    utils::feed(hash_state, static_cast<int>(key.leaf));
+    utils::feed(hash_state, key.prices.get());
+    utils::feed(hash_state, key.center_offsets);
+    return hash_state.get_hash64();
+}
+
+vector<int> *MaxSCPHeuristicSingleLeaf::lookup_min_distances(
+    const ExplicitStateCPG *prices, LeafFactorID leaf) const {
+    MinDistanceKey key{leaf, prices->get_prices_identity(leaf), {}};
+    if (!key.prices) {
+        return nullptr;
+    }
+    const vector<PatternID> &mixed_patterns = leaf_tables[leaf].mixed_patterns;
+    key.center_offsets.reserve(mixed_patterns.size());
+    for (PatternID p_id : mixed_patterns) {
+        key.center_offsets.push_back(center_offsets[p_id]);
+    }
+
+    auto it = min_distance_cache.find(key);
+    if (it != min_distance_cache.end()) {
+        ++num_cache_hits;
+        min_distance_entries.splice(min_distance_entries.begin(), min_distance_entries, it->second);
+        return &it->second->min_distances;
+    }
+    ++num_cache_misses;
+    // The cache holds at least one entry per leaf, so the entries of the
+    // evaluated state are never evicted during the evaluation.
+    if (min_distance_entries.size() >= max(min_distance_cache_size, g_leaves.size())) {
+        min_distance_cache.erase(min_distance_entries.back().key);
+        min_distance_entries.pop_back();
+    }
+    min_distance_entries.push_front(
+        {key, vector<int>(cp_heuristics.size(), UNKNOWN_DISTANCE)});
+    min_distance_cache.emplace(move(key), min_distance_entries.begin());
+    return &min_distance_entries.front().min_distances;
+}
+
+void MaxSCPHeuristicSingleLeaf::extend_leaf_tables(LeafFactorID leaf) const {
+    LeafTables &tables = leaf_tables[leaf];
+    size_t num_states = g_state_registry->size(leaf);
+    size_t num_mixed = tables.mixed_patterns.size();
+    size_t num_orders = cp_heuristics.size();
+    tables.leaf_offsets.resize(num_states * num_mixed);
+    tables.leaf_only_h.resize(num_states * num_orders);
+
+    // only the leaf variables are set, so the center offsets are 0
+    vector<int> member_state(g_variable_domain.size(), 0);
+    for (LeafStateHash id(tables.num_states); id < num_states; ++id) {
+        set_leaf_facts(id, leaf, member_state);
+        int *offsets = tables.leaf_offsets.data() + id * num_mixed;
+        for (size_t i = 0; i < num_mixed; ++i) {
+            offsets[i] = abstraction_functions[tables.mixed_patterns[i]]->get_abstract_state_id(member_state);
+        }
+        int *leaf_only_h = tables.leaf_only_h.data() + id * num_orders;
+        for (size_t order = 0; order < num_orders; ++order) {
+            const CostPartitioningHeuristic &cp_heuristic = cp_heuristics[order];
+            int sum_h = 0;
+            for (int lookup_table_index : leaf_only_lookups[order][leaf]) {
+                const auto &lookup_table = cp_heuristic.lookup_tables[lookup_table_index];
+                int state_id = abstraction_functions[lookup_table.abstraction_id]->get_abstract_state_id(member_state);
+                assert(utils::in_bounds(state_id, lookup_table.h_values));
+                int h = lookup_table.h_values[state_id];
+                assert(h >= 0);
+                if (h == INF){
+                    sum_h = INF;
+                    break;
+                }
+                sum_h += h;
+            }
+            leaf_only_h[order] = sum_h;
         }
     }
+    tables.num_states = num_states;
 }
 
 int MaxSCPHeuristicSingleLeaf::compute_min_distance(
     const ExplicitStateCPG *prices,
-    const CostPartitioningHeuristic &cp_heuristic,
-    vector<int> &member_state,
+    int order,
     LeafFactorID leaf) const {
 
+    const LeafTables &tables = leaf_tables[leaf];
+    const CostPartitioningHeuristic &cp_heuristic = cp_heuristics[order];
+    const vector<MixedLookup> &lookups = mixed_lookups[order][leaf];
+    size_t num_mixed = tables.mixed_patterns.size();
+    size_t num_orders = cp_heuristics.size();
+
     int min_d = numeric_limits<int>::max();
 
     int number_states = prices->get_number_states(leaf);
@@ -75,28 +273,28 @@ int MaxSCPHeuristicSingleLeaf::compute_min_distance(
         if (prices->has_leaf_state(id, leaf)){
             --number_states;
 
-            set_leaf_facts(id, leaf, member_state);
-
             int price = prices->get_cost_of_state(id, leaf);
-            vector<int> abstract_state_ids = get_abstract_state_ids(abstraction_functions, member_state);
+            int sum_dists = tables.leaf_only_h[id * num_orders + order];
+            if (sum_dists == INF || price + sum_dists >= min_d){
+                ++id;
+                continue;
+            }
 
+            const int *offsets = tables.leaf_offsets.data() + id * num_mixed;
             bool is_dead_end_member_state = false;
-            int sum_dists = 0;
-            for (const auto &lookup_table : cp_heuristic.lookup_tables) {
-                if (affecting_patterns[leaf].count(lookup_table.abstraction_id)) {
-                    assert(utils::in_bounds(lookup_table.abstraction_id, abstract_state_ids));
-                    int state_id = abstract_state_ids[lookup_table.abstraction_id];
-                    assert(utils::in_bounds(state_id, lookup_table.h_values));
-                    int h = lookup_table.h_values[state_id];
-                    assert(h >= 0);
-                    if (h == numeric_limits<int>::max()){
-                        is_dead_end_member_state = true;
-                        break;
-                    }
-                    sum_dists += h;
-                    if (price + sum_dists >= min_d){
-                        break;
-                    }
+            for (const MixedLookup &lookup : lookups) {
+                const auto &lookup_table = cp_heuristic.lookup_tables[lookup.lookup_table_index];
+                int state_id = center_offsets[lookup_table.abstraction_id] + offsets[lookup.pattern_index];
+                assert(utils::in_bounds(state_id, lookup_table.h_values));
+                int h = lookup_table.h_values[state_id];
+                assert(h >= 0);
+                if (h == INF){
+                    is_dead_end_member_state = true;
+                    break;
+                }
+                sum_dists += h;
+                if (price + sum_dists >= min_d){
+                    break;
                 }
             }
 
@@ -110,57 +308,124 @@ int MaxSCPHeuristicSingleLeaf::compute_min_distance(
 }
 
 int MaxSCPHeuristicSingleLeaf::compute_heuristic(const GlobalState &state) {
+    utils::Timer timer;
+    int h = compute_max_h(state);
+    double time = timer();
+    ++num_evaluations;
+    evaluation_time += time;
+    if (h != DEAD_END) {
+        sum_finite_h += h;
+        ++num_finite_evaluations;
+    }
+    if (order_pruning_warm_up == 0) {
+        return h;
+    }
+    if (num_evaluations <= order_pruning_warm_up) {
+        warm_up_time += time;
+        if (num_evaluations == order_pruning_warm_up) {
+            prune_orders();
+        }
+    } else {
+        pruned_time += time;
+    }
+    return h;
+}
+
+int MaxSCPHeuristicSingleLeaf::compute_max_h(const GlobalState &state) {
     if (has_conditional_effects()){
         return 0;
     }
-    int max_h = 0;
-    vector<int> member_state;
+    // -1 so that the first order is credited if all orders tie at 0
+    int max_h = -1;
+    int best_order = -1;
     const ExplicitStateCPG *prices = nullptr;
-    if (!affecting_patterns.empty()) {
+    if (!is_affected_leaf.empty()) {
         prices = dynamic_cast<const ExplicitStateCPG*>(CPGStorage::storage->get_cpg(state));
-        member_state.resize(g_variable_domain.size(), -1);
-        set_center_facts(state, member_state);
+        for (LeafFactorID leaf(0); leaf < g_leaves.size(); ++leaf) {
+            if (is_affected_leaf[leaf] && leaf_tables[leaf].num_states < g_state_registry->size(leaf)){
+                extend_leaf_tables(leaf);
+            }
+        }
+        // for patterns without leaf variables, this is the abstract state id
+        for (PatternID p_id = 0; p_id < static_cast<int>(patterns.size()); ++p_id) {
+            if (abstraction_functions[p_id]) {
+                int offset = 0;
+                for (const auto &var_and_multiplier : abstraction_functions[p_id]->get_variables_and_multipliers()) {
+                    if (g_belongs_to_factor[var_and_multiplier.pattern_var] == LeafFactorID::CENTER) {
+                        offset += var_and_multiplier.hash_multiplier * state[var_and_multiplier.pattern_var];
+                    }
+                }
+                center_offsets[p_id] = offset;
+            }
+        }
+        if (min_distance_cache_size > 0) {
+            for (LeafFactorID leaf(0); leaf < g_leaves.size(); ++leaf) {
+                if (is_affected_leaf[leaf]) {
+                    cached_min_distances[leaf] = lookup_min_distances(prices, leaf);
+                }
+            }
+        }
     }
 
-    for (const auto &cp_heuristic : cp_heuristics) {
+    for (int order : active_orders) {
+        const CostPartitioningHeuristic &cp_heuristic = cp_heuristics[order];
         int sum_h = 0;
-        if (affecting_patterns.empty()){
+        if (is_affected_leaf.empty()){
             // all patterns only affect the center
             vector<int> abstract_state_ids = get_abstract_state_ids(
                 abstraction_functions, state);
             sum_h = cp_heuristic.compute_heuristic(abstract_state_ids);
             if (sum_h == numeric_limits<int>::max()){
                 // all reached leaf states are dead-ends
+                ++num_best_order[order];
                 return DEAD_END;
             }
         } else {
-            for (const auto &lookup_table : cp_heuristic.lookup_tables) {
-                if (center_only_patterns.count(lookup_table.abstraction_id)) {
-                    int state_id = abstraction_functions[lookup_table.abstraction_id]->get_abstract_state_id(state);
-                    assert(utils::in_bounds(state_id, lookup_table.h_values));
-                    int h = lookup_table.h_values[state_id];
-                    assert(h >= 0);
-                    if (h == INF) {
-                        return DEAD_END;
-                    }
-                    sum_h += h;
+            for (int lookup_table_index : center_only_lookups[order]) {
+                const auto &lookup_table = cp_heuristic.lookup_tables[lookup_table_index];
+                int state_id = center_offsets[lookup_table.abstraction_id];
+                assert(utils::in_bounds(state_id, lookup_table.h_values));
+                int h = lookup_table.h_values[state_id];
+                assert(h >= 0);
+                if (h == INF) {
+                    ++num_best_order[order];
+                    return DEAD_END;
                 }
+                sum_h += h;
             }
 
             for (LeafFactorID leaf(0); leaf < g_leaves.size(); ++leaf) {
-                if (!affecting_patterns[leaf].empty()){
-                    int h = compute_min_distance(prices, cp_heuristic, member_state, leaf);
+                if (is_affected_leaf[leaf]){
+                    vector<int> *cached = cached_min_distances[leaf];
+                    int h;
+                    if (cached && (*cached)[order] != UNKNOWN_DISTANCE) {
+                        h = (*cached)[order];
+                    } else {
+                        h = compute_min_distance(prices, order, leaf);
+                        if (cached) {
+                            (*cached)[order] = h;
+                        }
+                    }
                     if (h == numeric_limits<int>::max()){
                         // all reached leaf states are dead-ends
+                        ++num_best_order[order];
                         return DEAD_END;
                     }
                     sum_h += h;
                 }
             }
         }
-        max_h = max(max_h, sum_h);
+        if (sum_h > max_h) {
+            max_h = sum_h;
+            best_order = order;
+        }
+    }
+    if (best_order == -1) {
+        // no active orders
+        return 0;
     }
     assert(max_h >= 0);
+    ++num_best_order[best_order];
     if (max_h == INF) {
         return DEAD_END;
     }
@@ -171,6 +436,27 @@ static shared_ptr<Evaluator> _parse(OptionParser &parser) {
     prepare_parser_for_cost_partitioning_heuristic(parser);
     add_saturator_option(parser);
     add_order_options_to_parser(parser);
+    parser.add_option<int>(
+        "min_distance_cache_size",
+        "maximum number of (leaf, center abstract states, leaf prices) "
+        "combinations for which the min distances of all orders are cached "
+        "(least recently used first out); 0 disables the cache",
+        "10000",
+        Bounds("0", "infinity"));
+    parser.add_option<bool>(
+        "decoupled_samples",
+        "compute, optimize and diversify the orders for decoupled states sampled "
+        "with random walks over center actions and compare orders by their "
+        "decoupled heuristic value, instead of using explicit states "
+        "(only in decoupled search)",
+        "false");
+    parser.add_option<int>(
+        "order_pruning_warm_up",
+        "number of evaluations after which orders that were never the best "
+        "order, i.e., the first order with the maximal heuristic value, are "
+        "no longer evaluated; 0 disables the pruning",
+        "0",
+        Bounds("0", "infinity"));
     Heuristic::add_options_to_parser(parser);
 
     options::Options opts = parser.parse();
@@ -191,9 +477,15 @@ static shared_ptr<Evaluator> _parse(OptionParser &parser) {
         abstractions = generate_abstractions(
                 task, opts.get_list < shared_ptr < AbstractionGenerator >> ("abstractions"));
         CPFunction cp_function = get_cp_function_from_options(opts);
+        unique_ptr<DecoupledStateSampler> state_sampler;
+        if (g_factoring && opts.get<bool>("decoupled_samples")) {
+            verify_patterns_affect_single_leaf(abstractions);
+            state_sampler = utils::make_unique_ptr<DecoupledStateSampler>(
+                abstractions, costs, utils::parse_rng_from_options(opts));
+        }
         cp_heuristics =
                 get_cp_heuristic_collection_generator_from_options(opts).generate_cost_partitionings(
-                        task_proxy, abstractions, costs, cp_function);
+                        task_proxy, abstractions, costs, cp_function, state_sampler.get());
     } else {
         cout << "WARNING: task has conditional effects, skipping explicit PDB heuristic." << endl;
     }
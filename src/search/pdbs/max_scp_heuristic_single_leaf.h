@@ -5,21 +5,126 @@
 
 #include "../leaf_state_id.h"
 
-#include <unordered_set>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <vector>
 
 class ExplicitStateCPG;
 
 namespace pdbs {
 class MaxSCPHeuristicSingleLeaf : public MaxSCPHeuristic {
-    // for every leaf, we store the patterns that affect it
-    std::vector<std::unordered_set<PatternID>> affecting_patterns;
-    std::unordered_set<PatternID> center_only_patterns;
+    /*
+      The abstract state id of a projection is a weighted sum over the pattern
+      variables, so for a pattern affecting a leaf it splits into an offset
+      of the center variables, computed once per evaluation, and an offset of
+      the leaf variables, which we precompute per leaf state. The tables grow
+      lazily with the number of registered leaf states.
+    */
+    struct LeafTables {
+        // patterns affecting the leaf that also contain center variables
+        std::vector<PatternID> mixed_patterns;
+        // leaf offsets of the mixed patterns, one row per leaf state
+        std::vector<int> leaf_offsets;
+        // h of the patterns over leaf variables only, summed per order
+        // (INF if any is INF), one row per leaf state
+        std::vector<int> leaf_only_h;
+        size_t num_states = 0;
+    };
+
+    struct MixedLookup {
+        // index into the mixed patterns of the leaf
+        int pattern_index;
+        // index into the lookup tables of the order
+        int lookup_table_index;
+    };
+
+    // for every leaf, we store whether any pattern affects it
+    std::vector<bool> is_affected_leaf;
+    mutable std::vector<LeafTables> leaf_tables;
+    // indexed by order and leaf
+    std::vector<std::vector<std::vector<MixedLookup>>> mixed_lookups;
+    std::vector<std::vector<std::vector<int>>> leaf_only_lookups;
+    // indexed by order
+    std::vector<std::vector<int>> center_only_lookups;
+
+    // offsets of the center variables for all patterns in the evaluated state
+    mutable std::vector<int> center_offsets;
+
+    /*
+      The min distance of a leaf only depends on the center offsets of its
+      mixed patterns and on the prices of the leaf. We cache the min
+      distances of all orders for recently seen combinations, identifying
+      the prices by ExplicitStateCPG::get_prices_identity.
+    */
+    struct MinDistanceKey {
+        LeafFactorID leaf;
+        std::shared_ptr<const void> prices;
+        std::vector<int> center_offsets;
+
+        bool operator==(const MinDistanceKey &other) const {
+            return leaf == other.leaf && prices == other.prices &&
+                   center_offsets == other.center_offsets;
+        }
+    };
+
+    struct MinDistanceKeyHash {
+        std::size_t operator()(const MinDistanceKey &key) const;
+    };
+
+    struct MinDistanceEntry {
+        MinDistanceKey key;
+        // per order, UNKNOWN_DISTANCE if not computed yet
+        std::vector<int> min_distances;
+    };
+
+    static const int UNKNOWN_DISTANCE = -1;
+
+    // least recently used entries at the back
+    const size_t min_distance_cache_size;
+    mutable std::list<MinDistanceEntry> min_distance_entries;
+    mutable std::unordered_map<MinDistanceKey, std::list<MinDistanceEntry>::iterator,
+                               MinDistanceKeyHash> min_distance_cache;
+    // min distances of the affected leaves in the evaluated state
+    mutable std::vector<std::vector<int> *> cached_min_distances;
+    mutable uint64_t num_cache_hits;
+    mutable uint64_t num_cache_misses;
+
+    /*
+      We count how often each order is the best order (num_best_order): the
+      first order with the maximal value, or the order detecting a dead end.
+      After order_pruning_warm_up evaluations, orders that were never the best
+      order are no longer evaluated. The heuristic stays admissible, but it
+      may become less informed. 0 disables the pruning.
+    */
+    const int order_pruning_warm_up;
+    std::vector<int> active_orders;
+    int num_evaluations;
+    double warm_up_time;
+    double pruned_time;
+    /*
+      The quality of the orders per evaluation time, e.g. for orders computed
+      for decoupled and for explicit samples, is compared by the average
+      finite h value and the time of all evaluations.
+    */
+    int64_t sum_finite_h;
+    int num_finite_evaluations;
+    double evaluation_time;
+
+    void prune_orders();
+
+    std::vector<int> *lookup_min_distances(
+        const ExplicitStateCPG *prices, LeafFactorID leaf) const;
+
+    void extend_leaf_tables(LeafFactorID leaf) const;
 
     int compute_min_distance(
         const ExplicitStateCPG *prices,
-         const cost_saturation::CostPartitioningHeuristic &cp_heuristic,
-         std::vector<int> &member_state,
-         LeafFactorID leaf) const;
+        int order,
+        LeafFactorID leaf) const;
+
+    int compute_max_h(const GlobalState &state);
 protected:
     virtual int compute_heuristic(const GlobalState &ancestor_state) override;
 public:
@@ -27,7 +132,12 @@ public:
         const options::Options &opts,
         cost_saturation::Abstractions &&abstractions,
         cost_saturation::CPHeuristics &&cp_heuristics);
-    virtual ~MaxSCPHeuristicSingleLeaf() override = default;
+    virtual void print_statistics() const override;
+
+    // the lookups only extend the tables of this heuristic
+    virtual bool supports_concurrent_evaluation() const override {
+        return true;
+    }
 };
 }
 #endif
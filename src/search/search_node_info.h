@@ -4,9 +4,16 @@
 #include "operator.h"
 #include "state_id.h"
 
+#include <cassert>
+
 // For documentation on classes relevant to storing and working with registered
 // states see the file state_registry.h.
 
+/*
+  The part of a search node that is read and written during expansion.
+  The parent pointer is stored separately in SearchNodeParent, so that
+  the infos of many nodes share a cache line.
+*/
 struct SearchNodeInfo {
     enum NodeStatus {NEW = 0, OPEN = 1, CLOSED = 2, DEAD_END = 3};
 
@@ -14,24 +21,56 @@ struct SearchNodeInfo {
     int g : 30;
     int h : 31; // TODO:CR - should we get rid of it
     bool h_is_dirty : 1;
-    StateID parent_state_id;
-    OperatorID creating_operator;
     int real_g;
     int leaf_part_g;
 
     SearchNodeInfo()
         : status(NEW), g(-1), h(-1), h_is_dirty(false),
-          parent_state_id(StateID::no_state), creating_operator(OperatorID::no_operator),
           real_g(-1), leaf_part_g(-1) {
     }
 };
 
 /*
-  TODO: The C++ standard does not guarantee that bitfields with mixed
-        types (unsigned int, int, bool) are stored in the compact way
-        we desire. However, g++ does do what we want. To be safe for
-        the future, we should add a static assertion that verifies
-        that SearchNodeInfo has the desired size.
- */
+  The C++ standard does not guarantee that bitfields with mixed types
+  (unsigned int, int, bool) are stored in the compact way we desire, so
+  we verify it here.
+*/
+static_assert(sizeof(SearchNodeInfo) == 4 * sizeof(int),
+              "SearchNodeInfo is not packed into 16 bytes");
+
+/*
+  The parent pointer of a search node, which is only needed to extract
+  the plan (and to check for predecessors in decoupled dominance pruning).
+  StateIDs are stored in 32 bits, the state registry does not support
+  more states anyway.
+*/
+class SearchNodeParent {
+    static constexpr unsigned int NO_PARENT = static_cast<unsigned int>(-1);
+
+    unsigned int parent_state_id;
+    OperatorID creating_operator;
+
+public:
+    SearchNodeParent()
+        : parent_state_id(NO_PARENT), creating_operator(OperatorID::no_operator) {
+    }
+
+    void set(StateID parent, OperatorID op) {
+        assert(parent == StateID::no_state || parent.hash() < NO_PARENT);
+        parent_state_id = parent == StateID::no_state ? NO_PARENT : parent.hash();
+        creating_operator = op;
+    }
+
+    StateID get_parent_state_id() const {
+        return parent_state_id == NO_PARENT ? StateID::no_state : StateID(parent_state_id);
+    }
+
+    OperatorID get_creating_operator() const {
+        return creating_operator;
+    }
+};
+
+static_assert(sizeof(SearchNodeParent) == 2 * sizeof(int),
+              "SearchNodeParent is not packed into 8 bytes");
 
 #endif
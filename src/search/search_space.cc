@@ -17,12 +17,17 @@
 using namespace std;
 
 
-SearchNode::SearchNode(StateID state_id, SearchNodeInfo &info,
-                       OperatorCost cost_type)
-    : state_id(state_id), info(info), cost_type(cost_type) {
+SearchNode::SearchNode(SearchSpace &search_space, StateID state_id,
+                       SearchNodeInfo &info, OperatorCost cost_type)
+    : search_space(search_space), state_id(state_id), info(info),
+      cost_type(cost_type) {
     assert(state_id != StateID::no_state);
 }
 
+SearchNodeParent &SearchNode::get_parent() const {
+    return search_space.search_node_parents[get_state()];
+}
+
 GlobalState SearchNode::get_state() const {
     return g_state_registry->lookup_state(state_id);
 }
@@ -60,7 +65,7 @@ int SearchNode::get_h() const {
 }
 
 StateID SearchNode::get_parent_state_id() const {
-    return info.parent_state_id;
+    return get_parent().get_parent_state_id();
 }
 
 bool SearchNode::is_h_dirty() const {
@@ -82,8 +87,7 @@ void SearchNode::open_initial(int h) {
     info.leaf_part_g = 0;
     info.real_g = 0;
     info.h = h;
-    info.parent_state_id = StateID::no_state;
-    info.creating_operator = OperatorID::no_operator;
+    get_parent().set(StateID::no_state, OperatorID::no_operator);
 }
 
 void SearchNode::open(int h, const SearchNode &parent_node,
@@ -94,8 +98,7 @@ void SearchNode::open(int h, const SearchNode &parent_node,
     info.leaf_part_g = parent_node.info.leaf_part_g + g_inc_g_by;
     info.real_g = parent_node.info.real_g + g_operators[parent_op].get_cost() + g_inc_g_by;// HACK
     info.h = h;
-    info.parent_state_id = parent_node.get_state_id();
-    info.creating_operator = parent_op;
+    get_parent().set(parent_node.get_state_id(), parent_op);
     g_inc_g_by = 0;
 }
 
@@ -110,8 +113,7 @@ void SearchNode::reopen(const SearchNode &parent_node,
     info.g = parent_node.info.g + get_adjusted_action_cost(g_operators[parent_op], cost_type) + g_inc_g_by;
     info.leaf_part_g = parent_node.info.leaf_part_g + g_inc_g_by;
     info.real_g = parent_node.info.real_g + g_operators[parent_op].get_cost() + g_inc_g_by;// HACK
-    info.parent_state_id = parent_node.get_state_id();
-    info.creating_operator = parent_op;
+    get_parent().set(parent_node.get_state_id(), parent_op);
     g_inc_g_by = 0;
 }
 
@@ -125,8 +127,7 @@ void SearchNode::update_parent(const SearchNode &parent_node,
     info.g = parent_node.info.g + get_adjusted_action_cost(g_operators[parent_op], cost_type) + g_inc_g_by;
     info.leaf_part_g = parent_node.info.leaf_part_g + g_inc_g_by;
     info.real_g = parent_node.info.real_g + g_operators[parent_op].get_cost() + g_inc_g_by;// HACK
-    info.parent_state_id = parent_node.get_state_id();
-    info.creating_operator = parent_op;
+    get_parent().set(parent_node.get_state_id(), parent_op);
     g_inc_g_by = 0;
 }
 
@@ -153,9 +154,10 @@ void SearchNode::dump() const {
     cout << state_id << ": ";
     cout << "g = " << info.g << " h = " << info.h << endl;
     g_state_registry->lookup_state(state_id).dump_pddl();
-    if (info.creating_operator) {
-        cout << " created by " << g_operators[info.creating_operator].get_name()
-             << " from " << info.parent_state_id << endl;
+    const SearchNodeParent &parent = get_parent();
+    if (parent.get_creating_operator() != OperatorID::no_operator) {
+        cout << " created by " << g_operators[parent.get_creating_operator()].get_name()
+             << " from " << parent.get_parent_state_id() << endl;
     } else {
         cout << " no parent" << endl;
     }
@@ -169,7 +171,7 @@ SearchSpace::SearchSpace(OperatorCost cost_type_)
 }
 
 SearchNode SearchSpace::get_node(const GlobalState &state) {
-    return SearchNode(state.get_id(), search_node_infos[state], cost_type);
+    return SearchNode(*this, state.get_id(), search_node_infos[state], cost_type);
 }
 
 void SearchSpace::trace_path(const GlobalState &goal_state,
@@ -192,8 +194,8 @@ void SearchSpace::trace_path(const GlobalState &goal_state,
     assert(path.empty());
 
     for (;;) {          // backtrace solution path
-        const SearchNodeInfo &info = search_node_infos[current_state];
-        OperatorID op = info.creating_operator;
+        const SearchNodeParent &parent = search_node_parents[current_state];
+        OperatorID op = parent.get_creating_operator();
 
         if (g_factoring || g_symmetry_graph){
             states.push_back(current_state.get_id());
@@ -202,7 +204,7 @@ void SearchSpace::trace_path(const GlobalState &goal_state,
         if (g_symmetry_graph){
             GlobalState new_state = g_initial_state();
             if (op != OperatorID::no_operator) {
-                GlobalState parent_state = g_state_registry->lookup_state(info.parent_state_id);
+                GlobalState parent_state = g_state_registry->lookup_state(parent.get_parent_state_id());
                 new_state = g_state_registry->get_successor_state(parent_state, g_operators[op], false);
             } else {
                 new_state = g_state_registry->get_state(g_initial_state_data);
@@ -215,14 +217,14 @@ void SearchSpace::trace_path(const GlobalState &goal_state,
         }
 
         if (op == OperatorID::no_operator) {  // reached initial state => done
-            assert(info.parent_state_id == StateID::no_state);
+            assert(parent.get_parent_state_id() == StateID::no_state);
             break;
         }
 
         if (!g_symmetry_graph || g_factoring){
             path.push_back(op);
         }
-        current_state = g_state_registry->lookup_state(info.parent_state_id);
+        current_state = g_state_registry->lookup_state(parent.get_parent_state_id());
     }
 
     if (g_symmetry_graph && !g_factoring){
@@ -287,12 +289,13 @@ void SearchSpace::dump() const {
          it != search_node_infos.end(g_state_registry); ++it) {
         StateID id = *it;
         GlobalState s = g_state_registry->lookup_state(id);
-        const SearchNodeInfo &node_info = search_node_infos[s];
+        const SearchNodeParent &parent = search_node_parents[s];
         cout << id << ": ";
         s.dump_fdr();
-        if (node_info.creating_operator && node_info.parent_state_id != StateID::no_state) {
-            cout << " created by " << g_operators[node_info.creating_operator].get_name()
-                 << " from " << node_info.parent_state_id << endl;
+        if (parent.get_creating_operator() != OperatorID::no_operator &&
+                parent.get_parent_state_id() != StateID::no_state) {
+            cout << " created by " << g_operators[parent.get_creating_operator()].get_name()
+                 << " from " << parent.get_parent_state_id() << endl;
         } else {
             cout << "has no parent" << endl;
         }
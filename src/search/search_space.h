@@ -10,18 +10,27 @@
 
 
 class Operator;
+class SearchSpace;
 
 namespace symmetries {
 class Permutation;
 }
 
+/*
+  The parent pointer is looked up in the search space only when it is read or
+  written, so that expansions which only check the status and g value of a
+  node do not touch the parent array.
+*/
 class SearchNode {
+    SearchSpace &search_space;
     StateID state_id;
     SearchNodeInfo &info;
     OperatorCost cost_type;
+
+    SearchNodeParent &get_parent() const;
 public:
-    SearchNode(StateID state_id, SearchNodeInfo &info,
-               OperatorCost cost_type);
+    SearchNode(SearchSpace &search_space, StateID state_id,
+               SearchNodeInfo &info, OperatorCost cost_type);
 
     StateID get_state_id() const {
         return state_id;
@@ -60,9 +69,13 @@ public:
 
 class SearchSpace {
     friend class PathPrices; // to reconstruct leaf paths
+    friend class SearchNode; // to look up parents on demand
 
     PerStateInformation<SearchNodeInfo> search_node_infos;
 
+    // kept apart from search_node_infos, only needed for plan extraction
+    PerStateInformation<SearchNodeParent> search_node_parents;
+
     OperatorCost cost_type;
 
     void trace_symmetric_path(std::vector<OperatorID> &path,
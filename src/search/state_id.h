@@ -8,6 +8,7 @@
 
 class StateID {
     friend class StateRegistry;
+    friend class SearchNodeParent;
     friend std::ostream &operator<<(std::ostream &os, StateID id);
     template<typename>
     friend class PerStateInformation;
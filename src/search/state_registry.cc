@@ -20,17 +20,16 @@ StateRegistry::StateRegistry()
       state_data_pool(g_state_packer->get_num_bins()),
       leaf_state_data_pool(vector<segmented_vector::SegmentedArrayVector<PackedStateBin>* >
                                 (g_factoring ? g_leaves.size() : 0, 0)),
-      registered_states(0,
-                        StateIDSemanticHash(state_data_pool, g_state_packer->get_num_bins()),
+      registered_states(StateIDSemanticHash(state_data_pool, g_state_packer->get_num_bins()),
                         StateIDSemanticEqual(state_data_pool, g_state_packer->get_num_bins())),
-      registered_leaf_states(vector<LeafStateIDSet>(g_factoring ? g_leaves.size() : 0,
-                             LeafStateIDSet(0, LeafStateIDSemanticHash(leaf_state_data_pool),
-                                                LeafStateIDSemanticEqual(leaf_state_data_pool)))),
       cached_initial_state(0) {
     if (g_factoring){
+        registered_leaf_states.reserve(g_leaves.size());
         for (LeafFactorID factor(0); factor < g_leaves.size(); ++factor){
-            leaf_state_data_pool[factor] = new segmented_vector::SegmentedArrayVector<PackedStateBin>
-                                        (g_leaf_state_packers[factor]->get_num_bins());
+            int num_bins = g_leaf_state_packers[factor]->get_num_bins();
+            leaf_state_data_pool[factor] = new segmented_vector::SegmentedArrayVector<PackedStateBin>(num_bins);
+            registered_leaf_states.emplace_back(LeafStateIDSemanticHash(*leaf_state_data_pool[factor], num_bins),
+                                                LeafStateIDSemanticEqual(*leaf_state_data_pool[factor], num_bins));
         }
     }
 }
@@ -55,14 +54,15 @@ StateID StateRegistry::insert_id_or_pop_state() {
       is present), we have to remove the duplicate entry from the
       state data pool.
     */
-    StateID id(state_data_pool.size() - 1);
-    pair<StateIDSet::iterator, bool> result = registered_states.insert(id);
+    int id = state_data_pool.size() - 1;
+    pair<int, bool> result = registered_states.insert(id);
     if (!result.second) {
         // is known state
         state_data_pool.pop_back();
     }
-    assert(registered_states.size() == state_data_pool.size());
-    return *result.first;
+    // decoupled states with dup counter > 0 are not in registered_states
+    assert(static_cast<size_t>(registered_states.size()) <= state_data_pool.size());
+    return StateID(result.first);
 }
 
 LeafStateHash StateRegistry::insert_id_or_pop_leaf_state(LeafFactorID factor) {
@@ -72,15 +72,15 @@ LeafStateHash StateRegistry::insert_id_or_pop_leaf_state(LeafFactorID factor) {
       is present), we have to remove the duplicate entry from the
       state data pool.
     */
-    LeafStateID id(LeafStateHash(leaf_state_data_pool[factor]->size() - 1), factor);
-    assert(id.value < LeafStateHash::MAX);
-    pair<LeafStateIDSet::iterator, bool> result = registered_leaf_states[factor].insert(id);
+    int id = leaf_state_data_pool[factor]->size() - 1;
+    assert(LeafStateHash(id) < LeafStateHash::MAX);
+    pair<int, bool> result = registered_leaf_states[factor].insert(id);
     if (!result.second) {
         // is known leaf state
         leaf_state_data_pool[factor]->pop_back();
     }
-    assert(registered_leaf_states[factor].size() == leaf_state_data_pool[factor]->size());
-    return result.first->value;
+    assert(static_cast<size_t>(registered_leaf_states[factor].size()) == leaf_state_data_pool[factor]->size());
+    return LeafStateHash(result.first);
 }
 
 GlobalState StateRegistry::lookup_state(StateID id) const {
@@ -105,7 +105,6 @@ const GlobalState &StateRegistry::get_initial_state() {
                 leaf_buffers[factor].reset(new PackedStateBin[g_leaf_state_packers[factor]->get_num_bins()]);
                 fill_n(leaf_buffers[factor].get(), g_leaf_state_packers[factor]->get_num_bins(), 0);
             }
-            g_state_packer->set(center_buffer.get(), g_center.size(), 0);
         }
 
         for (size_t var = 0; var < g_initial_state_data.size(); ++var) {
@@ -143,7 +142,7 @@ const GlobalState &StateRegistry::get_initial_state() {
 
             init_state_cpg->store_new_cpg(*cached_initial_state);
 
-            state_duplicate_counter[0] = 0;
+            decoupled_states[0].clear();
         }
 
 #ifdef DEBUG_SEARCH
@@ -172,13 +171,12 @@ void StateRegistry::permute_initial_state() {
         }
 
         if (changed){
-            registered_states.erase(cached_initial_state->get_id());
+            registered_states.erase(cached_initial_state->get_id().hash());
 
             PackedStateBin *sym_buffer = state_data_pool[state_data_pool.size() - 1];
             for (size_t var = 0; var < g_center.size(); ++var){
                 g_state_packer->set(sym_buffer, var, new_center[g_center[var]]);
             }
-            g_state_packer->set(sym_buffer, g_center.size(), 0);
 
             StateID id = insert_id_or_pop_state();
             assert(id.hash() == 0);
@@ -199,7 +197,7 @@ void StateRegistry::permute_initial_state() {
         }
 
         if (changed){
-            registered_states.erase(cached_initial_state->get_id());
+            registered_states.erase(cached_initial_state->get_id().hash());
 
             PackedStateBin *sym_buffer = state_data_pool[state_data_pool.size() - 1];
             for (size_t var = 0; var < g_variable_domain.size(); ++var){
@@ -247,7 +245,6 @@ GlobalState StateRegistry::get_decoupled_state_permutation(const GlobalState &st
     for (size_t var = 0; var < g_center.size(); ++var) {
         g_state_packer->set(buffer, var, permuted[g_center[var]]);
     }
-    g_state_packer->set(buffer, g_center.size(), 0);
 
     return lookup_state(insert_id_or_pop_state());
 }
@@ -293,7 +290,6 @@ GlobalState StateRegistry::get_successor_state(const GlobalState &predecessor, c
             // no need to check does_fire here, because no conditional effects allowed (yet)
             g_state_packer->set(buffer, g_new_index[eff.var], eff.val);
         }
-        g_state_packer->set(buffer, g_center.size(), 0);
     }
 
     StateID id = insert_id_or_pop_state();
@@ -301,11 +297,7 @@ GlobalState StateRegistry::get_successor_state(const GlobalState &predecessor, c
     if (g_factoring){
         GlobalState s = lookup_state(id);
 
-        int old_dup_counter = -1;
-        DupCounterTable::iterator pos = state_duplicate_counter.find(id.hash());
-        if (pos != state_duplicate_counter.end()){
-            old_dup_counter = pos->second;
-        }
+        int old_dup_counter = get_max_dup_counter(id);
 
         PruningOptions::reset_ignore_current_state();
 
@@ -327,52 +319,42 @@ GlobalState StateRegistry::get_successor_state(const GlobalState &predecessor, c
                     // remove the newly added state if we do not need it later
                     state_data_pool.push_back(predecessor.get_packed_buffer());
                 } else {
-                    registered_states.erase(id);
+                    registered_states.erase(id.hash());
                 }
 
                 PackedStateBin *sym_buffer = state_data_pool[state_data_pool.size() - 1];
                 for (size_t var = 0; var < g_center.size(); ++var){
                     g_state_packer->set(sym_buffer, var, new_center[g_center[var]]);
                 }
-                g_state_packer->set(sym_buffer, g_center.size(), 0);
 
                 id = insert_id_or_pop_state();
                 s = lookup_state(id);
 
-                old_dup_counter = -1;
-                DupCounterTable::iterator pos = state_duplicate_counter.find(id.hash());
-                if (pos != state_duplicate_counter.end()){
-                    old_dup_counter = pos->second;
-                }
+                old_dup_counter = get_max_dup_counter(id);
             }
         }
 
         if (old_dup_counter == -1){ // is new center state
             CompliantPathGraph::notify_new_center_state(s, *new_cpg);
             new_cpg->store_new_cpg(s);
-            state_duplicate_counter[id.hash()] = 0;
+            decoupled_states[id.hash()];
         } else {
             auto start = std::chrono::high_resolution_clock::now();
             auto [new_dup_counter, replace_old_cpg] = new_cpg->check_dominance(s, old_dup_counter, predecessor, op);
             dominance_pruning_timer += std::chrono::high_resolution_clock::now() - start;
-            if (new_dup_counter >= MAX_DUPLICATE_COUNTER){
-                cerr << "Maximum number of decoupled states with the same center exceeded (" << MAX_DUPLICATE_COUNTER << "). Need to increase MAX_DUPLICATE_COUNTER in globals.cc and recompile [t=" << utils::g_timer << "]" << endl;
-                exit_with(utils::ExitCode::SEARCH_CRITICAL_ERROR);
-            }
-
-            state_data_pool.push_back(s.get_packed_buffer());
-            buffer = state_data_pool[state_data_pool.size() - 1];
-            g_state_packer->set(buffer, g_center.size(), new_dup_counter);
-
-            size_t base_state_id = id.hash();
-
-            id = insert_id_or_pop_state();
-            s = lookup_state(id);
 
             if (new_dup_counter > old_dup_counter){
-                // is a new decoupled state
-                state_duplicate_counter[base_state_id] = new_dup_counter;
+                // is a new decoupled state, its buffer is a copy of the base state
+                // that is not registered in registered_states
+                assert(new_dup_counter == old_dup_counter + 1);
+                vector<StateID> &duplicates = decoupled_states[id.hash()];
+                state_data_pool.push_back(s.get_packed_buffer());
+                id = StateID(state_data_pool.size() - 1);
+                duplicates.push_back(id);
+            } else if (new_dup_counter > 0){
+                id = decoupled_states[id.hash()][new_dup_counter - 1];
             }
+            s = lookup_state(id);
 
             if (new_dup_counter > old_dup_counter || replace_old_cpg){
                 // new decoupled state, or new decoupled state dominates an existing one => replace cpg
@@ -411,7 +393,7 @@ GlobalState StateRegistry::get_successor_state(const GlobalState &predecessor, c
             if (id.hash() + 1 != state_data_pool.size()){
                 state_data_pool.push_back(s.get_packed_buffer());
             } else {
-                registered_states.erase(id);
+                registered_states.erase(id.hash());
             }
 
             PackedStateBin *sym_buffer = state_data_pool[state_data_pool.size() - 1];
@@ -448,7 +430,6 @@ GlobalState StateRegistry::get_center_state(const vector<int> &facts) {
     for (size_t var = 0; var < g_center.size(); ++var) {
         g_state_packer->set(buffer, var, facts[g_center[var]]);
     }
-    g_state_packer->set(buffer, g_center.size(), 0);
 
     StateID id = insert_id_or_pop_state();
     return lookup_state(id);
@@ -456,16 +437,20 @@ GlobalState StateRegistry::get_center_state(const vector<int> &facts) {
 
 GlobalState StateRegistry::get_decoupled_state(const GlobalState &base_state, int dup_counter) {
     assert(dup_counter >= 0);
-    assert(dup_counter < MAX_DUPLICATE_COUNTER);
-
-    state_data_pool.push_back(base_state.get_packed_buffer());
-    PackedStateBin *buffer = state_data_pool[state_data_pool.size() - 1];
-
-    g_state_packer->set(buffer, g_center.size(), dup_counter);
-
-    StateID id = insert_id_or_pop_state();
+    if (dup_counter == 0){
+        return base_state;
+    }
+    const auto it = decoupled_states.find(base_state.get_id().hash());
+    assert(it != decoupled_states.end() && static_cast<size_t>(dup_counter) <= it->second.size());
+    return lookup_state(it->second[dup_counter - 1]);
+}
 
-    return lookup_state(id);
+int StateRegistry::get_max_dup_counter(StateID base_state_id) const {
+    const auto it = decoupled_states.find(base_state_id.hash());
+    if (it == decoupled_states.end()){
+        return -1;
+    }
+    return it->second.size();
 }
 
 GlobalState StateRegistry::get_center_successor(const GlobalState &center, const Operator& op) {
@@ -476,7 +461,6 @@ GlobalState StateRegistry::get_center_successor(const GlobalState &center, const
         // no need to check does_fire here, because no conditional effects allowed (yet)
         g_state_packer->set(buffer, g_new_index[eff.var], eff.val);
     }
-    g_state_packer->set(buffer, g_center.size(), 0);
 
     StateID id = insert_id_or_pop_state();
     return lookup_state(id);
@@ -519,13 +503,14 @@ void StateRegistry::print_decoupled_search_statistics() const {
     // sum_leaves(|leaf| * #reachable leaf states) + sum_s(|center| + sum_leaves(#reachable leaf states in s))
     size_t dec_size = sizeof(PackedStateBin) * g_state_packer->get_num_bins() * size();
     uint64_t num_member_states = 0;
+    size_t cpg_size = 0;
 
     for (LeafFactorID factor(0); factor < g_leaves.size(); ++factor){
         dec_size += sizeof(PackedStateBin) * g_leaf_state_packers[factor]->get_num_bins() * size(factor);
     }
 
     for (size_t i = 0; i < CPGStorage::storage->size(this); ++i){
-        dec_size += CPGStorage::storage->get_cpg(lookup_state(StateID(i)))->get_memory_footprint();
+        cpg_size += CPGStorage::storage->get_cpg(lookup_state(StateID(i)))->get_memory_footprint();
         if (g_factoring->get_leaf_representation_type() == LEAF_REPRESENTATION_TYPE::EXPLICIT){
             const ExplicitStateCPG *cpg = static_cast<const ExplicitStateCPG *>(CPGStorage::storage->get_cpg(lookup_state(StateID(i))));
             int num_member_states_state = 1;
@@ -535,7 +520,12 @@ void StateRegistry::print_decoupled_search_statistics() const {
             num_member_states += num_member_states_state;
         }
     }
+    dec_size += cpg_size;
     cout << "decoupled state space size " << dec_size << endl;
+    if (CPGStorage::storage->size(this) > 0){
+        cout << "Average compliant path graph size (bytes): "
+                << (cpg_size / CPGStorage::storage->size(this)) << endl;
+    }
 
     if (g_factoring->get_leaf_representation_type() == LEAF_REPRESENTATION_TYPE::EXPLICIT){
         cout << "Average number of member states (generated decoupled states): "
@@ -544,9 +534,9 @@ void StateRegistry::print_decoupled_search_statistics() const {
 
     cout << "Time spent on dominance pruning: " << dominance_pruning_timer.count() << "s" << endl;
 
-    int m = 0;
-    for (DupCounterTable::const_iterator it = state_duplicate_counter.begin(); it != state_duplicate_counter.end(); ++it){
-        m = max(m, (int) it->second);
+    size_t m = 0;
+    for (const auto &entry : decoupled_states){
+        m = max(m, entry.second.size());
     }
     cout << "maximum duplicate counter " << m << endl;
 }
@@ -2,6 +2,7 @@
 #define STATE_REGISTRY_H
 
 #include "algorithms/segmented_vector.h"
+#include "algorithms/int_hash_set.h"
 #include "algorithms/int_packer.h"
 #include "globals.h"
 #include "leaf_state.h"
@@ -11,8 +12,8 @@
 #include "utils/hash.h"
 
 #include <chrono>
+#include <cstdint>
 #include <set>
-#include <unordered_set>
 #include <unordered_map>
 #include <vector>
 
@@ -112,6 +113,24 @@ class PerStateInformationBase;
 class StateRegistry {
     friend class SearchEngine; // to permute initial state
 
+    /*
+      Hash of packed (center or leaf) state data. The Jenkins hash of
+      utils::HashState by default, compile with USE_BLOCK_STATE_HASH to use
+      the faster 64-bit block hash utils::hash_block instead.
+     */
+    static int_hash_set::HashType hash_packed_state(const PackedStateBin *data, int state_size) {
+#ifdef USE_BLOCK_STATE_HASH
+        static_assert(sizeof(PackedStateBin) == sizeof(std::uint32_t), "block hash expects 32-bit bins");
+        return utils::fold_hash(utils::hash_block(data, state_size));
+#else
+        utils::HashState hash_state;
+        for (int i = 0; i < state_size; ++i) {
+            hash_state.feed(data[i]);
+        }
+        return hash_state.get_hash32();
+#endif
+    }
+
     struct StateIDSemanticHash {
         const segmented_vector::SegmentedArrayVector<PackedStateBin> &state_data_pool;
         int state_size;
@@ -122,13 +141,8 @@ class StateRegistry {
           state_size(state_size) {
         }
 
-        size_t operator()(StateID id) const {
-            const PackedStateBin *data = state_data_pool[id.value];
-            utils::HashState hash_state;
-            for (int i = 0; i < state_size; ++i) {
-                hash_state.feed(data[i]);
-            }
-            return hash_state.get_hash32();
+        int_hash_set::HashType operator()(int id) const {
+            return hash_packed_state(state_data_pool[id], state_size);
         }
     };
 
@@ -142,57 +156,41 @@ class StateRegistry {
           state_size(state_size) {
         }
 
-        bool operator()(StateID lhs, StateID rhs) const {
-            const PackedStateBin *lhs_data = state_data_pool[lhs.value];
-            const PackedStateBin *rhs_data = state_data_pool[rhs.value];
+        bool operator()(int lhs, int rhs) const {
+            const PackedStateBin *lhs_data = state_data_pool[lhs];
+            const PackedStateBin *rhs_data = state_data_pool[rhs];
             return std::equal(lhs_data, lhs_data + state_size, rhs_data);
         }
     };
 
+    // hash and equality of the leaf states of a single factor
     struct LeafStateIDSemanticHash {
-        const std::vector<segmented_vector::SegmentedArrayVector<PackedStateBin>* > &data_pool;
-        std::vector<int> state_sizes;
-        LeafStateIDSemanticHash(const std::vector<segmented_vector::SegmentedArrayVector<PackedStateBin>* > &state_data_pool_)
-        : data_pool(state_data_pool_) {
-            if (g_factoring){
-                // we need the guard for abstain_type COMPUTE_RUN_STANDARD, where
-                // g_leaves is set, but we run explicit-state search
-                state_sizes.resize(g_leaves.size());
-                for (size_t i = 0; i < g_leaves.size(); ++i){
-                    state_sizes[i] = g_leaf_state_packers[i]->get_num_bins();
-                }
-            }
+        const segmented_vector::SegmentedArrayVector<PackedStateBin> &data_pool;
+        int state_size;
+        LeafStateIDSemanticHash(const segmented_vector::SegmentedArrayVector<PackedStateBin> &data_pool,
+                                int state_size)
+        : data_pool(data_pool),
+          state_size(state_size) {
         }
-        size_t operator() (const LeafStateID &id) const {
-            const PackedStateBin *data = (*data_pool[id.factor])[id.value];
-            utils::HashState hash_state;
-            for (int i = 0; i < state_sizes[id.factor]; ++i) {
-                hash_state.feed(data[i]);
-            }
-            return hash_state.get_hash32();
+
+        int_hash_set::HashType operator()(int id) const {
+            return hash_packed_state(data_pool[id], state_size);
         }
     };
 
     struct LeafStateIDSemanticEqual {
-        const std::vector<segmented_vector::SegmentedArrayVector<PackedStateBin>* > &data_pool;
-        std::vector<int> state_sizes;
-        LeafStateIDSemanticEqual(const std::vector<segmented_vector::SegmentedArrayVector<PackedStateBin>* > &state_data_pool_)
-        : data_pool(state_data_pool_) {
-            if (g_factoring){
-                // we need the guard for abstain_type COMPUTE_RUN_STANDARD, where
-                // g_leaves is set, but we run explicit-state search
-                state_sizes.resize(g_leaves.size());
-                for (size_t i = 0; i < g_leaves.size(); ++i){
-                    state_sizes[i] = g_leaf_state_packers[i]->get_num_bins();
-                }
-            }
+        const segmented_vector::SegmentedArrayVector<PackedStateBin> &data_pool;
+        int state_size;
+        LeafStateIDSemanticEqual(const segmented_vector::SegmentedArrayVector<PackedStateBin> &data_pool,
+                                 int state_size)
+        : data_pool(data_pool),
+          state_size(state_size) {
         }
 
-        bool operator() (const LeafStateID &lhs, const LeafStateID &rhs) const {
-            assert(lhs.factor == rhs.factor);
-            const PackedStateBin *lhs_data = (*data_pool[lhs.factor])[lhs.value];
-            const PackedStateBin *rhs_data = (*data_pool[rhs.factor])[rhs.value];
-            return std::equal(lhs_data, lhs_data + state_sizes[lhs.factor], rhs_data);
+        bool operator()(int lhs, int rhs) const {
+            const PackedStateBin *lhs_data = data_pool[lhs];
+            const PackedStateBin *rhs_data = data_pool[rhs];
+            return std::equal(lhs_data, lhs_data + state_size, rhs_data);
         }
     };
 
@@ -200,15 +198,17 @@ class StateRegistry {
       Hash set of StateIDs used to detect states that are already registered in
       this registry and find their IDs. GlobalStates are compared/hashed semantically,
       i.e. the actual state data is compared, not the memory location.
+
+      The sets use open addressing and keep the 32 bit hash of every key in
+      its bucket, so the packed state data is only compared if the hashes
+      match. The leaf state sets are keyed by LeafStateHash.
      */
 
-    using StateIDSet = std::unordered_set<StateID, StateIDSemanticHash, StateIDSemanticEqual>;
+    using StateIDSet = int_hash_set::IntHashSet<StateIDSemanticHash, StateIDSemanticEqual>;
 
-    using LeafStateIDSet = std::unordered_set<LeafStateID,
-            LeafStateIDSemanticHash,
-            LeafStateIDSemanticEqual>;
+    using LeafStateIDSet = int_hash_set::IntHashSet<LeafStateIDSemanticHash, LeafStateIDSemanticEqual>;
 
-    using DupCounterTable = std::unordered_map<size_t, size_t>;
+    using DecoupledStateTable = std::unordered_map<size_t, std::vector<StateID>>;
 
 
     std::chrono::duration<double> dominance_pruning_timer;
@@ -224,10 +224,13 @@ class StateRegistry {
     GlobalState *cached_initial_state;
 
     /*
-      maps the StateID of the base state to the number of different decoupled
-      states that have the same center
+      maps the StateID of the base state (dup counter 0) to the IDs of the
+      other decoupled states that have the same center, the decoupled state
+      with dup counter i > 0 is at position i - 1. Only base states are
+      registered in registered_states, the other decoupled states share
+      their packed center data.
      */
-    DupCounterTable state_duplicate_counter;
+    DecoupledStateTable decoupled_states;
 
     mutable std::set<PerStateInformationBase *> subscribers;
 
@@ -277,11 +280,17 @@ public:
     GlobalState get_center_state(const std::vector<int> &facts);
 
     /*
-      returns the state resulting from setting the last variable (dup counter)
-      to dup_counter
+      returns the decoupled state with the center of base_state and the given
+      dup counter, which must have been generated before
      */
     GlobalState get_decoupled_state(const GlobalState &base_state, int dup_counter);
 
+    /*
+      the number of decoupled states with this base state - 1, or -1 if
+      the center state was not reached in the search yet
+     */
+    int get_max_dup_counter(StateID base_state_id) const;
+
     GlobalState get_center_successor(const GlobalState &center, const Operator &op);
 
     /**
@@ -295,7 +304,7 @@ public:
       Returns the number of states registered so far.
      */
     size_t size() const {
-        return registered_states.size();
+        return state_data_pool.size();
     }
 
     /*
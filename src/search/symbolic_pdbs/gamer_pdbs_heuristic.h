@@ -70,6 +70,11 @@ protected:
 public:
     GamerPDBsHeuristic(const options::Options &opts);
     virtual ~GamerPDBsHeuristic() = default;
+
+    // the ADDs and the lookup caches belong to the CUDD manager of this heuristic
+    virtual bool supports_concurrent_evaluation() const override {
+        return true;
+    }
 };
 
 }
@@ -1,6 +1,8 @@
 #include "lookup_add_decoupled_heuristic.h"
 
 #include "cuddInt.h"
+#include <algorithm>
+#include <limits>
 #include <unordered_map>
 #include <vector>
 #include <memory>
@@ -11,46 +13,185 @@
 #include "../symbolic/prices_ADD.h"
 
 #include "../compliant_paths/cpg_storage.h"
+
+#include "../utils/timer.h"
 using namespace std;
 
 namespace symbolic {
 
+    int LookupAddDecoupledHeuristicRecursive::flatten_add(DdNode *f, DdNode *plus_infinity,
+                                                          unordered_map<DdNode *, int> &index,
+                                                          vector<FlatNode> &nodes) {
+        assert(Cudd_Regular(f) == f); //Check that all nodes are not complemented (as we are in an ADD)
+        auto it = index.find(f);
+        if (it != index.end()) {
+            return it->second;
+        }
+        FlatNode node;
+        if (cuddIsConstant(f)) {
+            node.bdd_var = -1;
+            node.then_child = -1;
+            node.else_child = -1;
+            node.value = f == plus_infinity ? std::numeric_limits<int>::max() : static_cast<int>(cuddV(f));
+        } else {
+            node.bdd_var = f->index;
+            node.then_child = flatten_add(cuddT(f), plus_infinity, index, nodes);
+            node.else_child = flatten_add(cuddE(f), plus_infinity, index, nodes);
+            node.value = 0;
+        }
+        int id = nodes.size();
+        nodes.push_back(node);
+        index[f] = id;
+        return id;
+    }
+
+    LookupAddDecoupledHeuristicRecursive::FlatADD &
+    LookupAddDecoupledHeuristicRecursive::get_flat_add(const ADD &heuristic) const {
+        // gamer_pdbs looks up at most two ADDs (perimeter and PDB)
+        for (const auto &flat_add : flat_adds) {
+            if (flat_add->add.getNode() == heuristic.getNode()) {
+                return *flat_add;
+            }
+        }
+        auto flat_add = std::make_unique<FlatADD>();
+        flat_add->add = heuristic;
+        unordered_map<DdNode *, int> index;
+        flat_add->root = flatten_add(heuristic.getNode(), vars->plusInfinity().getNode(), index, flat_add->nodes);
+        flat_add->memo.resize(flat_add->nodes.size());
+        flat_add->memo_epoch.resize(flat_add->nodes.size(), 0);
+        flat_adds.push_back(move(flat_add));
+        return *flat_adds.back();
+    }
+
+    void LookupAddDecoupledHeuristicRecursive::extend_leaf_encodings(LeafFactorID leaf) const {
+        const vector<int> &bdd_vars = leaf_bdd_vars[leaf];
+        vector<char> &encodings = leaf_encodings[leaf];
+        size_t num_states = g_state_registry->size(leaf);
+        encodings.reserve(num_states * bdd_vars.size());
+        for (LeafStateHash id(num_encoded_leaf_states[leaf]); id < num_states; ++id) {
+            LeafState l_state = g_state_registry->lookup_leaf_state(id, leaf);
+            for (int leaf_var : g_leaves[leaf]) {
+                int value = l_state[leaf_var];
+                size_t num_bdd_vars = vars->vars_index_pre(leaf_var).size();
+                for (size_t pos = 0; pos < num_bdd_vars; ++pos) {
+                    encodings.push_back((value >> pos) % 2);
+                }
+            }
+        }
+        assert(encodings.size() == num_states * bdd_vars.size());
+        num_encoded_leaf_states[leaf] = num_states;
+    }
+
     int LookupAddDecoupledHeuristicRecursive::lookup(const ADD &heuristic, const GlobalState &state) const {
-        vector<int> binary_assignment(vars->getNumBDDVars()*2, -1);
+        FlatADD &flat_add = get_flat_add(heuristic);
         set_binary_encoding_center(binary_assignment, state);
         const auto *prices = dynamic_cast<const ExplicitStateCPG *>(CPGStorage::storage->get_cpg(state));
-        std::unordered_map<DdNode *, int> cache;
-        return lookup_recursive(heuristic.getNode(), binary_assignment, prices, cache);
+        for (LeafFactorID leaf(0); leaf < g_leaves.size(); ++leaf) {
+            if (num_encoded_leaf_states[leaf] < g_state_registry->size(leaf)) {
+                extend_leaf_encodings(leaf);
+            }
+        }
+        if (++epoch == 0) {
+            // stamps wrapped around, invalidate all memo values
+            for (const auto &other : flat_adds) {
+                fill(other->memo_epoch.begin(), other->memo_epoch.end(), 0);
+            }
+            epoch = 1;
+        }
+        return lookup_recursive(flat_add, flat_add.root, prices);
+    }
+
+    int LookupAddDecoupledHeuristicRecursive::restrict_node(FlatADD &flat_add, int node_id, LeafFactorID leaf,
+                                                            const char *encoding,
+                                                            unordered_map<int, int> &restricted) const {
+        // copy, restricting may append to the nodes
+        FlatNode node = flat_add.nodes[node_id];
+        if (node.bdd_var == -1) {
+            return node_id;
+        }
+        if (leaf_bdd_var[node.bdd_var] == leaf) {
+            int next = encoding[leaf_bdd_var_position[node.bdd_var]] ? node.then_child : node.else_child;
+            return restrict_node(flat_add, next, leaf, encoding, restricted);
+        }
+        auto it = restricted.find(node_id);
+        if (it != restricted.end()) {
+            return it->second;
+        }
+        int then_child = restrict_node(flat_add, node.then_child, leaf, encoding, restricted);
+        int else_child = restrict_node(flat_add, node.else_child, leaf, encoding, restricted);
+        int result;
+        if (then_child == else_child) {
+            result = then_child;
+        } else {
+            // sub-ADDs without variables of the leaf map back to their original node
+            auto inserted = flat_add.unique_table.emplace(
+                make_pair(node.bdd_var, make_pair(then_child, else_child)), flat_add.nodes.size());
+            if (inserted.second) {
+                flat_add.nodes.push_back({node.bdd_var, then_child, else_child, 0});
+                ++num_restricted_nodes;
+            }
+            result = inserted.first->second;
+        }
+        restricted[node_id] = result;
+        return result;
     }
 
-    int LookupAddDecoupledHeuristicRecursive::lookup_recursive(DdNode *f, vector<int> &binary_assignment,
-                                                      const ExplicitStateCPG *prices,
-                                                      std::unordered_map<DdNode *, int> &cache) const {
-        // in cache for all nodes, we store the minimum heuristic + price of all the leafs below
+    int LookupAddDecoupledHeuristicRecursive::get_restricted_root(FlatADD &flat_add, int node_id, LeafFactorID leaf,
+                                                                  LeafStateHash id) const {
+        vector<int> &roots = flat_add.restricted_roots[node_id];
+        if (id >= roots.size()) {
+            roots.resize(g_state_registry->size(leaf), -1);
+        }
+        if (roots[id] != -1 || num_restricted_nodes >= max_restricted_nodes) {
+            return roots[id];
+        }
+
+        utils::Timer timer;
+        if (flat_add.unique_table.empty()) {
+            for (int i = 0; i < static_cast<int>(flat_add.nodes.size()); ++i) {
+                const FlatNode &node = flat_add.nodes[i];
+                if (node.bdd_var != -1) {
+                    flat_add.unique_table.emplace(make_pair(node.bdd_var, make_pair(node.then_child, node.else_child)), i);
+                }
+            }
+        }
+        if (id >= num_encoded_leaf_states[leaf]) {
+            extend_leaf_encodings(leaf);
+        }
+        const char *encoding = leaf_encodings[leaf].data() + id * leaf_bdd_vars[leaf].size();
+        unordered_map<int, int> restricted;
+        roots[id] = restrict_node(flat_add, node_id, leaf, encoding, restricted);
+        flat_add.memo.resize(flat_add.nodes.size());
+        flat_add.memo_epoch.resize(flat_add.nodes.size(), 0);
+        ++num_restrictions;
+        restriction_time += timer();
+        return roots[id];
+    }
+
+    int LookupAddDecoupledHeuristicRecursive::lookup_recursive(FlatADD &flat_add, int node_id,
+                                                               const ExplicitStateCPG *prices) const {
+        // in the memo for all nodes, we store the minimum heuristic + price of all the leafs below
         // prices gives us the price of each leaf
         // state gives us the value for center variables
-        assert(Cudd_Regular(f) == f); //Check that all nodes are not complemented (as we are in an ADD)
+        // copy, restricting may append to the nodes
+        FlatNode node = flat_add.nodes[node_id];
 
         //Base case
-        if (cuddIsConstant(f)) {
-            if (f == vars->plusInfinity().getNode()) {
-                return std::numeric_limits<int>::max();
-            } else {
-                return cuddV(f);
-            }
+        if (node.bdd_var == -1) {
+            return node.value;
         }
 
         //Recursive case
-        int bdd_var = f->index;
+        int bdd_var = node.bdd_var;
         // If the variable has already an assigned value, then go down that path
         if (binary_assignment[bdd_var] != -1) {
             // just go down via this path
-            DdNode *next = binary_assignment[bdd_var] == 1 ? cuddT(f) : cuddE(f);
-            return lookup_recursive(next, binary_assignment, prices, cache);
+            int next = binary_assignment[bdd_var] == 1 ? node.then_child : node.else_child;
+            return lookup_recursive(flat_add, next, prices);
         }
 
-        if (cache[f]) {
-            return cache[f];
+        if (flat_add.memo_epoch[node_id] == epoch) {
+            return flat_add.memo[node_id];
         }
 
         // The assignment does not have a value because is related to a leaf.
@@ -61,11 +202,19 @@ namespace symbolic {
         for (LeafStateHash id(0); id < g_state_registry->size(leaf); ++id) {
             if (prices->has_leaf_state(id, leaf)) {
                 int cost = prices->get_cost_of_state(id, leaf);
-                set_binary_encoding_leaf(binary_assignment, id, leaf);
 
-                DdNode *next = binary_assignment[bdd_var] ? cuddT(f) : cuddE(f);
+                // the restricted sub-ADD does not contain variables of the leaf, so it is
+                // evaluated without assigning them
+                int next = restrict_leaves ? get_restricted_root(flat_add, node_id, leaf, id) : -1;
+                if (next != -1) {
+                    ++num_restricted_lookups;
+                } else {
+                    ++num_walked_lookups;
+                    set_binary_encoding_leaf(binary_assignment, id, leaf);
+                    next = binary_assignment[bdd_var] ? node.then_child : node.else_child;
+                }
 
-                int recursive_result = lookup_recursive(next, binary_assignment, prices, cache);
+                int recursive_result = lookup_recursive(flat_add, next, prices);
 
                 if (recursive_result < std::numeric_limits<int>::max()) {
                     result = min(result, cost + recursive_result);
@@ -77,13 +226,12 @@ namespace symbolic {
             }
         }
         //reset binary_assignment[bdd_var] = -1 for all bdd_vars in leaf
-        for (int fd_var : g_leaves[leaf]) {
-            for (int bdd_v : vars->vars_index_pre(fd_var)) {
-                binary_assignment[bdd_v] = -1;
-            }
+        for (int bdd_v : leaf_bdd_vars[leaf]) {
+            binary_assignment[bdd_v] = -1;
         }
 
-        cache[f] = result;
+        flat_add.memo[node_id] = result;
+        flat_add.memo_epoch[node_id] = epoch;
         return result;
     }
 
@@ -99,9 +247,13 @@ namespace symbolic {
 
     void
     LookupAddDecoupledHeuristicRecursive::set_binary_encoding_leaf(vector<int> &binary_assignment, LeafStateHash leaf_state_id, LeafFactorID leaf_id) const {
-        LeafState l_state = g_state_registry->lookup_leaf_state(leaf_state_id, leaf_id);
-        for (int leaf_var : g_leaves[leaf_id]){
-            set_binary_encoding(vars, binary_assignment, leaf_var, l_state[leaf_var]);
+        if (leaf_state_id >= num_encoded_leaf_states[leaf_id]) {
+            extend_leaf_encodings(leaf_id);
+        }
+        const vector<int> &bdd_vars = leaf_bdd_vars[leaf_id];
+        const char *encoding = leaf_encodings[leaf_id].data() + leaf_state_id * bdd_vars.size();
+        for (size_t i = 0; i < bdd_vars.size(); ++i) {
+            binary_assignment[bdd_vars[i]] = encoding[i];
         }
     }
 
@@ -112,10 +264,31 @@ namespace symbolic {
         }
     }
 
-    LookupAddDecoupledHeuristicRecursive::LookupAddDecoupledHeuristicRecursive(const Options & ) {
+    LookupAddDecoupledHeuristicRecursive::LookupAddDecoupledHeuristicRecursive(const Options &opts)
+        : restrict_leaves(opts.get<bool>("restrict_leaves")),
+          max_restricted_nodes(opts.get<int>("max_restricted_nodes")) {
 
     }
 
+    LookupAddDecoupledHeuristicRecursive::~LookupAddDecoupledHeuristicRecursive() {
+        if (restrict_leaves) {
+            size_t num_nodes = 0;
+            size_t num_roots = 0;
+            for (const auto &flat_add : flat_adds) {
+                num_nodes += flat_add->nodes.size();
+                for (const auto &entry : flat_add->restricted_roots) {
+                    num_roots += entry.second.size();
+                }
+            }
+            cout << "Restricted leaf ADDs: " << num_restrictions << " restrictions in " << restriction_time << "s, "
+                 << num_restricted_nodes << " added nodes (" << num_nodes << " nodes in total, "
+                 << num_nodes * (sizeof(FlatNode) + sizeof(int) + sizeof(unsigned int)) + num_roots * sizeof(int)
+                 << " bytes without the unique tables)" << endl;
+            cout << "Leaf states evaluated on restricted ADDs: " << num_restricted_lookups
+                 << ", by assignment: " << num_walked_lookups << endl;
+        }
+    }
+
 
     void LookupAddDecoupledHeuristicRecursive::init() {
         leaf_bdd_var.reserve(vars->getNumBDDVars()*2);
@@ -123,6 +296,24 @@ namespace symbolic {
         for(int var = 0; var < vars->getNumBDDVars()*2; ++var) {
             leaf_bdd_var.push_back(g_belongs_to_factor[vars->getFDVar(var)]);
         }
+
+        leaf_bdd_vars.resize(g_leaves.size());
+        for (LeafFactorID leaf(0); leaf < g_leaves.size(); ++leaf) {
+            for (int leaf_var : g_leaves[leaf]) {
+                for (int bdd_var : vars->vars_index_pre(leaf_var)) {
+                    leaf_bdd_vars[leaf].push_back(bdd_var);
+                }
+            }
+        }
+        leaf_bdd_var_position.assign(vars->getNumBDDVars()*2, -1);
+        for (LeafFactorID leaf(0); leaf < g_leaves.size(); ++leaf) {
+            for (size_t i = 0; i < leaf_bdd_vars[leaf].size(); ++i) {
+                leaf_bdd_var_position[leaf_bdd_vars[leaf][i]] = i;
+            }
+        }
+        leaf_encodings.resize(g_leaves.size());
+        num_encoded_leaf_states.resize(g_leaves.size(), 0);
+        binary_assignment.assign(vars->getNumBDDVars()*2, -1);
     }
 
 
@@ -266,5 +457,28 @@ namespace symbolic {
 
     static Plugin<LookupAddDecoupledHeuristic> _plugin_1("explicit", _parse<LookupAddDecoupledHeuristicExplicit>);
     static Plugin<LookupAddDecoupledHeuristic> _plugin_2("add_ops", _parse<LookupAddDecoupledHeuristicADDOperations>);
-    static Plugin<LookupAddDecoupledHeuristic> _plugin_3("recursive", _parse<LookupAddDecoupledHeuristicRecursive>);
+    static shared_ptr<LookupAddDecoupledHeuristic> _parse_recursive(OptionParser &parser) {
+        parser.add_option<bool>("debug", "Debug options", "false");
+        parser.add_option<bool>(
+            "restrict_leaves",
+            "when the lookup enumerates the states of a leaf at a node, evaluate the sub-ADD restricted on "
+            "each leaf state instead of walking down the leaf variables. Restrictions are computed on "
+            "demand and kept.",
+            "false");
+        parser.add_option<int>(
+            "max_restricted_nodes",
+            "maximum number of nodes added by restrictions, leaf states without restriction are looked up "
+            "by assignment afterwards",
+            "10000000",
+            Bounds("0", "infinity"));
+        Options opts = parser.parse();
+
+        if (parser.help_mode() || parser.dry_run()) {
+            return nullptr;
+        } else {
+            return make_shared<LookupAddDecoupledHeuristicRecursive> (opts);
+        }
+    }
+
+    static Plugin<LookupAddDecoupledHeuristic> _plugin_3("recursive", _parse_recursive);
 }
\ No newline at end of file
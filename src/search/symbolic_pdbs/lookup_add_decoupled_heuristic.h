@@ -7,9 +7,12 @@
 
 
 #include <cuddObj.hh>
+#include <cstdint>
 #include <unordered_map>
 #include <memory>
+#include <vector>
 #include "../leaf_state_id.h"
+#include "../utils/hash.h"
 
 class ExplicitStateCPG;
 class GlobalState;
@@ -74,11 +77,69 @@ namespace symbolic {
     class LookupAddDecoupledHeuristicRecursive  : public LookupAddDecoupledHeuristic {
         std::vector<LeafFactorID> leaf_bdd_var; //For each bdd_variable indicates to what leaf it corresponds
 
-        int lookup_recursive(DdNode *f, std::vector<int> &binary_assignment, const ExplicitStateCPG *prices,
-                             std::unordered_map<DdNode *, int> &cache) const;
+        /*
+         * The ADD is flattened once into an array of nodes with child indices, so that the lookup
+         * works on node indices only. Memo values are valid if their stamp matches the current epoch,
+         * which is incremented for every lookup instead of clearing the memo.
+         */
+        struct FlatNode {
+            int bdd_var; // -1 for constants
+            int then_child;
+            int else_child;
+            int value; // constants only, max int for +infinity
+        };
+
+        struct FlatADD {
+            ADD add; // keeps the nodes alive
+            std::vector<FlatNode> nodes;
+            int root;
+            std::vector<int> memo;
+            std::vector<unsigned int> memo_epoch;
+
+            /*
+             * Restricted mode: for a node of a leaf variable reached while the leaf is unassigned, the
+             * root of the sub-ADD restricted on each leaf state (-1 if not computed yet). Restricted
+             * nodes are appended to nodes, the unique table makes them share structure.
+             */
+            std::unordered_map<int, std::vector<int>> restricted_roots;
+            utils::HashMap<std::pair<int, std::pair<int, int>>, int> unique_table;
+        };
+
+        mutable std::vector<std::unique_ptr<FlatADD>> flat_adds;
+        mutable unsigned int epoch = 0;
+
+        // the bdd variables of each leaf and, per leaf state, their values (row by row)
+        std::vector<std::vector<int>> leaf_bdd_vars;
+        mutable std::vector<std::vector<char>> leaf_encodings;
+        mutable std::vector<size_t> num_encoded_leaf_states;
+
+        // -1 for unassigned bdd variables, only the center variables stay assigned between lookups
+        mutable std::vector<int> binary_assignment;
+        // position of each leaf bdd variable in the bdd variables of its leaf
+        std::vector<int> leaf_bdd_var_position;
+
+        const bool restrict_leaves;
+        const int max_restricted_nodes;
+        // statistics of the restricted mode
+        mutable int num_restricted_nodes = 0;
+        mutable uint64_t num_restrictions = 0;
+        mutable uint64_t num_restricted_lookups = 0;
+        mutable uint64_t num_walked_lookups = 0;
+        mutable double restriction_time = 0;
+
+        int get_restricted_root(FlatADD &flat_add, int node_id, LeafFactorID leaf, LeafStateHash id) const;
+        int restrict_node(FlatADD &flat_add, int node_id, LeafFactorID leaf, const char *encoding,
+                          std::unordered_map<int, int> &restricted) const;
+
+        static int flatten_add(DdNode *f, DdNode *plus_infinity, std::unordered_map<DdNode *, int> &index,
+                               std::vector<FlatNode> &nodes);
+        FlatADD &get_flat_add(const ADD &heuristic) const;
+        void extend_leaf_encodings(LeafFactorID leaf) const;
+
+        int lookup_recursive(FlatADD &flat_add, int node, const ExplicitStateCPG *prices) const;
     public:
         explicit LookupAddDecoupledHeuristicRecursive(const options::Options& opts);
-        ~LookupAddDecoupledHeuristicRecursive() override = default;
+        ~LookupAddDecoupledHeuristicRecursive() override;
 
         void init() override;
 
@@ -86,6 +86,10 @@ inline uint32_t rotate(uint32_t value, uint32_t offset) {
     return (value << offset) | (value >> (32 - offset));
 }
 
+inline uint64_t rotate64(uint64_t value, uint32_t offset) {
+    return (value << offset) | (value >> (64 - offset));
+}
+
 /*
   Store the state of the hashing process.
 
@@ -207,6 +211,77 @@ public:
 };
 
 
+/*
+  Multiply two 64-bit values and fold the 128-bit product into 64 bits by
+  XORing its halves ("mum" in wyhash).
+*/
+inline std::uint64_t mum(std::uint64_t a, std::uint64_t b) {
+#ifdef __SIZEOF_INT128__
+    __extension__ typedef unsigned __int128 uint128;
+    uint128 product = static_cast<uint128>(a) * b;
+    return static_cast<std::uint64_t>(product) ^ static_cast<std::uint64_t>(product >> 64);
+#else
+    std::uint64_t a_lo = a & 0xFFFFFFFFULL;
+    std::uint64_t a_hi = a >> 32;
+    std::uint64_t b_lo = b & 0xFFFFFFFFULL;
+    std::uint64_t b_hi = b >> 32;
+    std::uint64_t lo_lo = a_lo * b_lo;
+    std::uint64_t hi_lo = a_hi * b_lo;
+    std::uint64_t lo_hi = a_lo * b_hi;
+    std::uint64_t hi_hi = a_hi * b_hi;
+    std::uint64_t cross = (lo_lo >> 32) + (hi_lo & 0xFFFFFFFFULL) + lo_hi;
+    std::uint64_t high = hi_hi + (hi_lo >> 32) + (cross >> 32);
+    std::uint64_t low = (cross << 32) | (lo_lo & 0xFFFFFFFFULL);
+    return low ^ high;
+#endif
+}
+
+/*
+  Hash a block of 32-bit values, e.g. a packed state, in the style of
+  wyhash: pairs of values are combined into 64-bit words and mixed with
+  64x64->128 bit multiplications, using two independent lanes so that the
+  multiplications of consecutive words can overlap.
+
+  This is much faster than feeding the values to HashState one by one for
+  long blocks, but it is not compositional. The length is part of the
+  hash, so blocks of different lengths can be mixed.
+*/
+inline std::uint64_t hash_block(const std::uint32_t *data, std::size_t size) {
+    const std::uint64_t P0 = 0xa0761d6478bd642fULL;
+    const std::uint64_t P1 = 0xe7037ed1a0b428dbULL;
+    const std::uint64_t P2 = 0x8ebc6af09c88c6e3ULL;
+    const std::uint64_t P3 = 0x589965cc75374cc3ULL;
+
+    std::uint64_t lane0 = P0 ^ mum(size ^ P1, P2);
+    std::uint64_t lane1 = P1;
+    std::size_t i = 0;
+    for (; i + 4 <= size; i += 4) {
+        std::uint64_t word0 = data[i] | (static_cast<std::uint64_t>(data[i + 1]) << 32);
+        std::uint64_t word1 = data[i + 2] | (static_cast<std::uint64_t>(data[i + 3]) << 32);
+        lane0 = mum(word0 ^ P1, lane0 ^ P2);
+        lane1 = mum(word1 ^ P3, lane1 ^ P0);
+    }
+    std::uint64_t a = 0;
+    std::uint64_t b = 0;
+    if (i + 2 <= size) {
+        a = data[i] | (static_cast<std::uint64_t>(data[i + 1]) << 32);
+        i += 2;
+    }
+    if (i < size) {
+        b = data[i];
+    }
+    std::uint64_t hash = mum(a ^ P1, b ^ lane0 ^ rotate64(lane1, 32));
+    return mum(hash ^ P0, size ^ P3);
+}
+
+/*
+  Fold a 64-bit hash into 32 bits.
+*/
+inline std::uint32_t fold_hash(std::uint64_t hash) {
+    return static_cast<std::uint32_t>(hash) ^ static_cast<std::uint32_t>(hash >> 32);
+}
+
+
 /*
   These functions add a new object to an existing HashState object.
 
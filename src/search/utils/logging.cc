@@ -12,6 +12,8 @@
 using namespace std;
 
 namespace utils {
+thread_local bool Log::line_has_started = false;
+
 /*
   NOTE: When adding more options to Log, make sure to adapt the if block in
   get_log_from_options below to test for *all* default values used for
@@ -33,11 +33,16 @@ enum class Verbosity {
 class Log {
     std::ostream &stream;
     const Verbosity verbosity;
-    bool line_has_started;
+    /*
+      All logs write to cout. The flag is kept per thread, because threads
+      constructing predefinitions concurrently write separate lines (see
+      ConcurrentPredefinitions).
+    */
+    static thread_local bool line_has_started;
 
 public:
     explicit Log(Verbosity verbosity)
-        : stream(std::cout), verbosity(verbosity), line_has_started(false) {
+        : stream(std::cout), verbosity(verbosity) {
     }
 
     template<typename T>
@@ -7,6 +7,10 @@
 using namespace std;
 
 namespace utils {
+static const int DEFAULT_SEED = 2011;
+
+static thread_local shared_ptr<RandomNumberGenerator> thread_local_rng;
+
 void add_rng_options(options::OptionParser &parser) {
     parser.add_option<int>(
         "random_seed",
@@ -21,12 +25,24 @@ shared_ptr<RandomNumberGenerator> parse_rng_from_options(
     const options::Options &options) {
     int seed = options.get<int>("random_seed");
     if (seed == -1) {
+        if (thread_local_rng) {
+            return thread_local_rng;
+        }
         // Use an arbitrary default seed.
         static shared_ptr<utils::RandomNumberGenerator> rng =
-            make_shared<utils::RandomNumberGenerator>(2011);
+            make_shared<utils::RandomNumberGenerator>(DEFAULT_SEED);
         return rng;
     } else {
         return make_shared<RandomNumberGenerator>(seed);
     }
 }
+
+ThreadLocalGlobalRNGScope::ThreadLocalGlobalRNGScope()
+    : previous(thread_local_rng) {
+    thread_local_rng = make_shared<RandomNumberGenerator>(DEFAULT_SEED);
+}
+
+ThreadLocalGlobalRNGScope::~ThreadLocalGlobalRNGScope() {
+    thread_local_rng = previous;
+}
 }
@@ -21,6 +21,21 @@ extern void add_rng_options(options::OptionParser &parser);
 */
 extern std::shared_ptr<RandomNumberGenerator> parse_rng_from_options(
     const options::Options &options);
+
+/*
+  While an instance of this class is alive, parse_rng_from_options returns a
+  fresh RNG with the default seed instead of the global RNG on the calling
+  thread. Plugins constructed concurrently thus do not share the global RNG.
+*/
+class ThreadLocalGlobalRNGScope {
+    std::shared_ptr<RandomNumberGenerator> previous;
+public:
+    ThreadLocalGlobalRNGScope();
+    ~ThreadLocalGlobalRNGScope();
+
+    ThreadLocalGlobalRNGScope(const ThreadLocalGlobalRNGScope &) = delete;
+    ThreadLocalGlobalRNGScope &operator=(const ThreadLocalGlobalRNGScope &) = delete;
+};
 }
 
 #endif
@@ -63,6 +63,8 @@ bool is_exit_code_error_reentrant(ExitCode exitcode);
 void register_event_handlers();
 void report_exit_code_reentrant(ExitCode exitcode);
 int get_process_id();
+// soft CPU time limit of the process in seconds, infinity if there is none
+double get_cpu_time_limit();
 }
 
 #endif
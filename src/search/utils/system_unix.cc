@@ -33,6 +33,7 @@
 #include <limits>
 #include <new>
 #include <stdlib.h>
+#include <sys/resource.h>
 #include <unistd.h>
 
 #if OPERATING_SYSTEM == OSX
@@ -267,6 +268,13 @@ void report_exit_code_reentrant(ExitCode exitcode) {
 int get_process_id() {
     return getpid();
 }
+
+double get_cpu_time_limit() {
+    rlimit limit;
+    if (getrlimit(RLIMIT_CPU, &limit) != 0 || limit.rlim_cur == RLIM_INFINITY)
+        return numeric_limits<double>::infinity();
+    return static_cast<double>(limit.rlim_cur);
+}
 }
 
 #endif
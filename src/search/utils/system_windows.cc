@@ -7,6 +7,7 @@
 #include <csignal>
 #include <ctime>
 #include <iostream>
+#include <limits>
 #include <process.h>
 #include <psapi.h>
 
@@ -73,6 +74,11 @@ void report_exit_code_reentrant(ExitCode exitcode) {
 int get_process_id() {
     return _getpid();
 }
+
+double get_cpu_time_limit() {
+    // The driver cannot set time limits on Windows.
+    return numeric_limits<double>::infinity();
+}
 }
 
 #endif
@@ -0,0 +1,79 @@
+#include "thread_pool.h"
+
+#include <cassert>
+
+using namespace std;
+
+namespace utils {
+ThreadPool::ThreadPool(int num_threads)
+    : task(nullptr),
+      num_tasks(0),
+      next_task(0),
+      num_finished(0),
+      generation(0),
+      shutting_down(false) {
+    assert(num_threads >= 1);
+    workers.reserve(num_threads - 1);
+    for (int i = 1; i < num_threads; ++i) {
+        workers.emplace_back(&ThreadPool::worker_loop, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        lock_guard<mutex> lock(state_mutex);
+        shutting_down = true;
+    }
+    work_available.notify_all();
+    for (thread &worker : workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::work_off(unique_lock<mutex> &lock) {
+    while (next_task < num_tasks) {
+        size_t id = next_task++;
+        lock.unlock();
+        (*task)(id);
+        lock.lock();
+        if (++num_finished == num_tasks) {
+            work_done.notify_all();
+        }
+    }
+}
+
+void ThreadPool::worker_loop() {
+    size_t seen_generation = 0;
+    unique_lock<mutex> lock(state_mutex);
+    while (true) {
+        work_available.wait(lock, [&]() {
+            return shutting_down || generation != seen_generation;
+        });
+        if (shutting_down) {
+            return;
+        }
+        seen_generation = generation;
+        work_off(lock);
+    }
+}
+
+void ThreadPool::run(size_t num_tasks_, const function<void(size_t)> &task_) {
+    if (workers.empty() || num_tasks_ <= 1) {
+        for (size_t id = 0; id < num_tasks_; ++id) {
+            task_(id);
+        }
+        return;
+    }
+    unique_lock<mutex> lock(state_mutex);
+    task = &task_;
+    num_tasks = num_tasks_;
+    next_task = 0;
+    num_finished = 0;
+    ++generation;
+    work_available.notify_all();
+    work_off(lock);
+    work_done.wait(lock, [&]() {return num_finished == num_tasks; });
+    task = nullptr;
+    num_tasks = 0;
+}
+}
@@ -0,0 +1,52 @@
+#ifndef UTILS_THREAD_POOL_H
+#define UTILS_THREAD_POOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace utils {
+/*
+  Fixed set of worker threads for fork-join parallelism: run() executes
+  task(0), ..., task(num_tasks - 1) on the workers and the calling thread
+  and returns once all of them finished. Tasks must not call run() on the
+  same pool.
+*/
+class ThreadPool {
+    std::vector<std::thread> workers;
+
+    std::mutex state_mutex;
+    std::condition_variable work_available;
+    std::condition_variable work_done;
+
+    const std::function<void(size_t)> *task;
+    size_t num_tasks;
+    size_t next_task;
+    size_t num_finished;
+    // incremented for every call of run(), so workers notice new work
+    size_t generation;
+    bool shutting_down;
+
+    // executes unclaimed tasks of the current generation, mutex must be held
+    void work_off(std::unique_lock<std::mutex> &lock);
+    void worker_loop();
+public:
+    // num_threads includes the calling thread, so num_threads - 1 workers are started
+    explicit ThreadPool(int num_threads);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    void run(size_t num_tasks, const std::function<void(size_t)> &task);
+
+    int get_num_threads() const {
+        return workers.size() + 1;
+    }
+};
+}
+
+#endif
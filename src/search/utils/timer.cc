@@ -50,7 +50,10 @@ void mach_absolute_difference(uint64_t end, uint64_t start, struct timespec *tp)
 #endif
 
 
-Timer::Timer() {
+static thread_local bool create_wall_clock_timers = false;
+
+Timer::Timer()
+    : wall_clock(create_wall_clock_timers) {
 #if OPERATING_SYSTEM == WINDOWS
     QueryPerformanceFrequency(&frequency);
     QueryPerformanceCounter(&start_ticks);
@@ -73,7 +76,7 @@ double Timer::current_clock() const {
     uint64_t end = mach_absolute_time();
     mach_absolute_difference(end, start, &tp);
 #else
-    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &tp);
+    clock_gettime(wall_clock ? CLOCK_MONOTONIC : CLOCK_PROCESS_CPUTIME_ID, &tp);
 #endif
     return tp.tv_sec + tp.tv_nsec / 1e9;
 #endif
@@ -112,5 +115,37 @@ ostream &operator<<(ostream &os, const Timer &timer) {
     return os;
 }
 
+WallClockTimerScope::WallClockTimerScope()
+    : previous(create_wall_clock_timers) {
+    create_wall_clock_timers = true;
+}
+
+WallClockTimerScope::~WallClockTimerScope() {
+    create_wall_clock_timers = previous;
+}
+
+double get_thread_cpu_time() {
+#if OPERATING_SYSTEM == WINDOWS
+    FILETIME creation_time;
+    FILETIME exit_time;
+    FILETIME kernel_time;
+    FILETIME user_time;
+    GetThreadTimes(GetCurrentThread(), &creation_time, &exit_time,
+                   &kernel_time, &user_time);
+    auto to_seconds = [](const FILETIME &time) {
+            ULARGE_INTEGER ticks;
+            ticks.LowPart = time.dwLowDateTime;
+            ticks.HighPart = time.dwHighDateTime;
+            // FILETIME counts 100 ns intervals
+            return static_cast<double>(ticks.QuadPart) / 1e7;
+        };
+    return to_seconds(kernel_time) + to_seconds(user_time);
+#else
+    timespec tp;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &tp);
+    return tp.tv_sec + tp.tv_nsec / 1e9;
+#endif
+}
+
 Timer g_timer;
 }
@@ -21,6 +21,8 @@ class Timer {
     double last_start_clock;
     double collected_time;
     bool stopped;
+    // see WallClockTimerScope
+    bool wall_clock;
 #if OPERATING_SYSTEM == WINDOWS
     LARGE_INTEGER frequency;
     LARGE_INTEGER start_ticks;
@@ -38,6 +40,30 @@ public:
 
 std::ostream &operator<<(std::ostream &os, const Timer &timer);
 
+/*
+  Timers measure the CPU time of the process, which grows faster than the
+  elapsed time while several threads are busy. While an instance of this class
+  is alive, timers created by the calling thread measure wall-clock time
+  instead, so that the time limits of computations running concurrently to
+  others keep their meaning.
+*/
+class WallClockTimerScope {
+    bool previous;
+public:
+    WallClockTimerScope();
+    ~WallClockTimerScope();
+
+    WallClockTimerScope(const WallClockTimerScope &) = delete;
+    WallClockTimerScope &operator=(const WallClockTimerScope &) = delete;
+};
+
+/*
+  CPU time used by the calling thread so far. Unlike the wall-clock time of
+  a computation, it does not include the time the thread waits for a core
+  while other threads run.
+*/
+extern double get_thread_cpu_time();
+
 extern Timer g_timer;
 }
 